@@ -0,0 +1,66 @@
+#pragma once
+
+// Помощники для замеров в bench/. Каждый замер — отдельная программа:
+//   g++ -std=c++20 -O2 -DNDEBUG -pthread bench/<name>-bench.cpp -o <name>
+// Время — лучшее из нескольких прогонов, чтобы меньше шумел планировщик.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+template <typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template <typename F>
+double best_of(int repeats, F f) {
+    double best = seconds(f);
+    for (int i = 1; i < repeats; ++i) {
+        best = std::min(best, seconds(f));
+    }
+    return best;
+}
+
+inline std::vector<int> random_keys(size_t n, std::uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::vector<int> keys(n);
+    for (int &key : keys) {
+        key = static_cast<int>(gen() >> 1);
+    }
+    return keys;
+}
+
+// Запускает fn(t) в threads потоках и возвращает время до конца последнего.
+template <typename F>
+double run_threads(size_t threads, F fn) {
+    return seconds([&] {
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < threads; ++t) {
+            pool.emplace_back([&fn, t] { fn(t); });
+        }
+        for (auto &thread : pool) {
+            thread.join();
+        }
+    });
+}
+
+inline void report(const char *name, double seconds, size_t ops) {
+    std::printf(
+        "%-44s %9.1f ms %9.1f ns/op\n", name, seconds * 1e3,
+        seconds * 1e9 / static_cast<double>(ops)
+    );
+}
+
+}  // namespace bench
@@ -0,0 +1,52 @@
+// insert_bulk против цикла insert: пачка неотсортированных ключей в пустое
+// множество и в множество, где уже столько же ключей.
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "bench.hpp"
+
+using my_algorithms::AvlSet;
+namespace execution = my_algorithms::execution;
+
+int main() {
+    const size_t n = 1'000'000;
+    std::vector<int> base = bench::random_keys(n, 1);
+    std::vector<int> batch = bench::random_keys(n, 2);
+    std::printf(
+        "%zu keys, %u hardware threads\n", n,
+        std::thread::hardware_concurrency()
+    );
+
+    for (bool preload : {false, true}) {
+        std::printf(preload ? "into %zu keys:\n" : "into an empty set:\n", n);
+        // Предзагрузка в замер не входит.
+        auto run = [&](auto insert) {
+            double best = 0;
+            for (int i = 0; i < 3; ++i) {
+                AvlSet<int> a;
+                if (preload) {
+                    a.insert_bulk(base.begin(), base.end());
+                }
+                double t = bench::seconds([&] { insert(a); });
+                best = i == 0 ? t : std::min(best, t);
+            }
+            return best;
+        };
+        double loop = run([&](AvlSet<int> &a) {
+            for (int key : batch) {
+                a.insert(key);
+            }
+        });
+        double seq = run([&](AvlSet<int> &a) {
+            a.insert_bulk(batch.begin(), batch.end(), execution::seq);
+        });
+        double par = run([&](AvlSet<int> &a) {
+            a.insert_bulk(batch.begin(), batch.end(), execution::par);
+        });
+        bench::report("  insert loop", loop, n);
+        bench::report("  insert_bulk(seq)", seq, n);
+        bench::report("  insert_bulk(par)", par, n);
+    }
+}
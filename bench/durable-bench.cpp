@@ -0,0 +1,102 @@
+// DurableAvlSet на локальном диске: задержка одной записи (каждая ждёт
+// fsync), пропускная способность с group commit при нескольких писателях
+// и время восстановления из журнала и из снимка.
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/durable-avl-set.hpp"
+#include "bench.hpp"
+
+using my_algorithms::DurableAvlSet;
+
+namespace {
+
+struct TempDir {
+    std::filesystem::path path;
+
+    explicit TempDir(const std::string &name)
+        : path(
+              std::filesystem::temp_directory_path() /
+              (name + "-" + std::to_string(::getpid()))
+          ) {
+        std::filesystem::remove_all(path);
+    }
+
+    ~TempDir() {
+        std::filesystem::remove_all(path);
+    }
+};
+
+double percentile(std::vector<double> &samples, double p) {
+    size_t k = static_cast<size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+}  // namespace
+
+int main() {
+    DurableAvlSet<int>::Options options;
+    options.checkpoint_every = 0;
+
+    {
+        TempDir dir("durable-bench-latency");
+        DurableAvlSet<int> a(dir.path, options);
+        std::vector<double> samples;
+        for (int i = 0; i < 2000; ++i) {
+            samples.push_back(bench::seconds([&] { a.insert(i); }));
+        }
+        std::printf(
+            "one writer, insert latency: p50 %.1f us, p99 %.1f us\n",
+            percentile(samples, 0.5) * 1e6, percentile(samples, 0.99) * 1e6
+        );
+    }
+
+    for (size_t writers : {1, 4, 16, 64}) {
+        TempDir dir("durable-bench-group");
+        DurableAvlSet<int> a(dir.path, options);
+        const size_t per_writer = 4000 / writers;
+        double t = bench::run_threads(writers, [&](size_t w) {
+            for (size_t i = 0; i < per_writer; ++i) {
+                a.insert(static_cast<int>(w * per_writer + i));
+            }
+        });
+        auto stats = a.stats();
+        std::printf(
+            "%2zu writers: %8.0f inserts/s, %.1f records per fsync\n",
+            writers, double(stats.records) / t,
+            double(stats.records) / double(stats.syncs)
+        );
+    }
+
+    {
+        TempDir dir("durable-bench-recovery");
+        const size_t n = 200'000;
+        {
+            DurableAvlSet<int> a(dir.path, options);
+            // Много писателей, чтобы fsync делился на большие группы.
+            bench::run_threads(64, [&](size_t w) {
+                for (size_t i = w; i < n; i += 64) {
+                    a.insert(static_cast<int>(i));
+                }
+            });
+        }
+        std::optional<DurableAvlSet<int>> a;
+        double replay = bench::seconds([&] { a.emplace(dir.path, options); });
+        auto replayed = a->stats().recovered_records;
+        double checkpoint = bench::seconds([&] { a->checkpoint(); });
+        a.reset();
+        double load = bench::seconds([&] { a.emplace(dir.path, options); });
+        std::printf(
+            "%zu keys: log replay (%llu records) %.1f ms, checkpoint "
+            "%.1f ms, recovery from checkpoint %.1f ms\n",
+            n, static_cast<unsigned long long>(replayed), replay * 1e3,
+            checkpoint * 1e3, load * 1e3
+        );
+    }
+}
@@ -0,0 +1,61 @@
+// Промахи contains с фильтром Блума перед деревом и без него: промах без
+// фильтра — полный спуск по дереву, с фильтром — одна кеш-линия фильтра.
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "bench.hpp"
+
+using my_algorithms::AvlSet;
+
+namespace {
+
+// Чётные ключи лежат в множестве, нечётные — промахи.
+std::vector<int> keys_with_parity(size_t n, std::uint32_t seed, int parity) {
+    std::vector<int> keys = bench::random_keys(n, seed);
+    for (int &key : keys) {
+        key = (key & ~1) | parity;
+    }
+    return keys;
+}
+
+double lookups(const AvlSet<int> &a, const std::vector<int> &keys) {
+    size_t found = 0;
+    double t = bench::best_of(3, [&] {
+        for (int key : keys) {
+            found += a.contains(key);
+        }
+    });
+    static_cast<void>(found);
+    return t;
+}
+
+}  // namespace
+
+int main() {
+    const size_t queries = 1'000'000;
+    std::vector<int> misses = keys_with_parity(queries, 2, 1);
+    for (size_t n : {size_t(1) << 16, size_t(1) << 20, size_t(1) << 22}) {
+        std::vector<int> present = keys_with_parity(n, 1, 0);
+        AvlSet<int> a;
+        a.insert_bulk(present.begin(), present.end());
+        std::vector<int> hits(
+            present.begin(), present.begin() + std::min(queries, n)
+        );
+
+        double miss_plain = lookups(a, misses);
+        double hit_plain = lookups(a, hits);
+        a.enable_filter(0.01);
+        double miss_filter = lookups(a, misses);
+        double hit_filter = lookups(a, hits);
+
+        std::printf(
+            "%zu keys, filter %.1f bits per key:\n", a.size(),
+            8.0 * double(a.filter()->memory_bytes()) / double(a.size())
+        );
+        bench::report("  miss, tree only", miss_plain, misses.size());
+        bench::report("  miss, filter + tree", miss_filter, misses.size());
+        bench::report("  hit, tree only", hit_plain, hits.size());
+        bench::report("  hit, filter + tree", hit_filter, hits.size());
+    }
+}
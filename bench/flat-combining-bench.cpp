@@ -0,0 +1,93 @@
+// FlatCombiningAvlSet против AvlSet под мьютексом при многих потоках:
+// каждый поток делает поровну insert, erase и contains случайных ключей.
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "../include/avl-set.hpp"
+#include "../include/flat-combining-avl-set.hpp"
+#include "bench.hpp"
+
+using my_algorithms::AvlSet;
+using my_algorithms::FlatCombiningAvlSet;
+
+namespace {
+
+constexpr int key_range = 1 << 20;
+
+struct LockedSet {
+    std::mutex mutex;
+    AvlSet<int> set;
+
+    bool insert(int key) {
+        std::lock_guard lock(mutex);
+        size_t before = set.size();
+        set.insert(key);
+        return set.size() != before;
+    }
+
+    bool erase(int key) {
+        std::lock_guard lock(mutex);
+        size_t before = set.size();
+        set.erase(key);
+        return set.size() != before;
+    }
+
+    bool contains(int key) {
+        std::lock_guard lock(mutex);
+        return set.contains(key);
+    }
+};
+
+template <typename Set>
+double run(Set &set, size_t threads, size_t ops_per_thread) {
+    return bench::run_threads(threads, [&](size_t t) {
+        std::mt19937 gen(static_cast<std::uint32_t>(t + 1));
+        size_t changed = 0;
+        for (size_t i = 0; i < ops_per_thread; ++i) {
+            int key = static_cast<int>(gen() % key_range);
+            switch (i % 3) {
+                case 0:
+                    changed += set.insert(key);
+                    break;
+                case 1:
+                    changed += set.erase(key);
+                    break;
+                default:
+                    changed += set.contains(key);
+            }
+        }
+        static_cast<void>(changed);
+    });
+}
+
+}  // namespace
+
+int main() {
+    const size_t total_ops = 1'200'000;
+    std::printf(
+        "%zu operations in total, %u hardware threads\n", total_ops,
+        std::thread::hardware_concurrency()
+    );
+    for (size_t threads : {1, 4, 16, 32, 64}) {
+        size_t per_thread = total_ops / threads;
+        LockedSet locked;
+        FlatCombiningAvlSet<int> combined;
+        for (int key = 0; key < key_range; key += 2) {
+            locked.set.insert(key);
+            combined.insert(key);
+        }
+        auto before = combined.stats();
+        double locked_time = run(locked, threads, per_thread);
+        double combined_time = run(combined, threads, per_thread);
+        auto after = combined.stats();
+        std::printf("%zu threads:\n", threads);
+        bench::report("  AvlSet + mutex", locked_time, total_ops);
+        bench::report("  FlatCombiningAvlSet", combined_time, total_ops);
+        std::printf(
+            "  operations per combining pass: %.2f\n",
+            double(after.operations - before.operations) /
+                double(after.passes - before.passes)
+        );
+    }
+}
@@ -0,0 +1,62 @@
+// Точечный поиск через хеш-индекс и через спуск по дереву: find с индексом
+// — одна-две кеш-линии таблицы и сам узел, без индекса — log n узлов.
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "bench.hpp"
+
+using my_algorithms::AvlSet;
+
+namespace {
+
+// Чётные ключи лежат в множестве, нечётные — промахи.
+std::vector<int> keys_with_parity(size_t n, std::uint32_t seed, int parity) {
+    std::vector<int> keys = bench::random_keys(n, seed);
+    for (int &key : keys) {
+        key = (key & ~1) | parity;
+    }
+    return keys;
+}
+
+double finds(const AvlSet<int> &a, const std::vector<int> &keys) {
+    size_t found = 0;
+    double t = bench::best_of(3, [&] {
+        for (int key : keys) {
+            found += a.find(key) != a.end();
+        }
+    });
+    static_cast<void>(found);
+    return t;
+}
+
+}  // namespace
+
+int main() {
+    const size_t queries = 1'000'000;
+    std::vector<int> misses = keys_with_parity(queries, 2, 1);
+    for (size_t n : {size_t(1) << 16, size_t(1) << 20, size_t(1) << 22}) {
+        std::vector<int> present = keys_with_parity(n, 1, 0);
+        AvlSet<int> a;
+        a.insert_bulk(present.begin(), present.end());
+        std::vector<int> hits = keys_with_parity(queries, 3, 0);
+        for (size_t i = 0; i < hits.size(); ++i) {
+            hits[i] = present[hits[i] % n];
+        }
+
+        double hit_tree = finds(a, hits);
+        double miss_tree = finds(a, misses);
+        a.enable_hash_index();
+        double hit_index = finds(a, hits);
+        double miss_index = finds(a, misses);
+
+        std::printf(
+            "%zu keys, index %.1f bytes per key:\n", a.size(),
+            double(a.hash_index()->memory_bytes()) / double(a.size())
+        );
+        bench::report("  hit, tree", hit_tree, hits.size());
+        bench::report("  hit, hash index", hit_index, hits.size());
+        bench::report("  miss, tree", miss_tree, misses.size());
+        bench::report("  miss, hash index", miss_index, misses.size());
+    }
+}
@@ -0,0 +1,100 @@
+// Пропускная способность ShardedAvlSet против одного AvlSet под мьютексом:
+// каждый поток делает поровну insert, erase и contains случайных ключей.
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "../include/sharded-avl-set.hpp"
+#include "bench.hpp"
+
+using my_algorithms::AvlSet;
+using my_algorithms::ShardedAvlSet;
+
+namespace {
+
+constexpr size_t shards = 16;
+constexpr int key_range = 1 << 20;
+
+struct LockedSet {
+    std::mutex mutex;
+    AvlSet<int> set;
+
+    void insert(int key) {
+        std::lock_guard lock(mutex);
+        set.insert(key);
+    }
+
+    void erase(int key) {
+        std::lock_guard lock(mutex);
+        set.erase(key);
+    }
+
+    bool contains(int key) {
+        std::lock_guard lock(mutex);
+        return set.contains(key);
+    }
+};
+
+template <typename Set>
+double run(Set &set, size_t threads, size_t ops_per_thread) {
+    return bench::run_threads(threads, [&](size_t t) {
+        std::mt19937 gen(static_cast<std::uint32_t>(t + 1));
+        size_t hits = 0;
+        for (size_t i = 0; i < ops_per_thread; ++i) {
+            int key = static_cast<int>(gen() % key_range);
+            switch (i % 3) {
+                case 0:
+                    set.insert(key);
+                    break;
+                case 1:
+                    set.erase(key);
+                    break;
+                default:
+                    hits += set.contains(key);
+            }
+        }
+        static_cast<void>(hits);
+    });
+}
+
+std::vector<int> even_boundaries() {
+    std::vector<int> res;
+    for (size_t i = 1; i < shards; ++i) {
+        res.push_back(static_cast<int>(key_range / shards * i));
+    }
+    return res;
+}
+
+}  // namespace
+
+int main() {
+    const size_t total_ops = 1'200'000;
+    std::printf(
+        "%zu operations in total, %u hardware threads\n", total_ops,
+        std::thread::hardware_concurrency()
+    );
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        size_t per_thread = total_ops / threads;
+        LockedSet locked;
+        ShardedAvlSet<int, shards> sharded(even_boundaries());
+        for (int key = 0; key < key_range; key += 2) {
+            locked.set.insert(key);
+            sharded.insert(key);
+        }
+        double locked_time = run(locked, threads, per_thread);
+        double sharded_time = run(sharded, threads, per_thread);
+        uint64_t contended = 0;
+        for (const auto &shard : sharded.stats()) {
+            contended += shard.contended;
+        }
+        std::printf("%zu threads:\n", threads);
+        bench::report("  AvlSet + mutex", locked_time, total_ops);
+        bench::report("  ShardedAvlSet<int, 16>", sharded_time, total_ops);
+        std::printf(
+            "  contended shard locks: %llu\n",
+            static_cast<unsigned long long>(contended)
+        );
+    }
+}
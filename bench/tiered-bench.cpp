@@ -0,0 +1,106 @@
+// Память на ключ и цена изменений у TieredAvlSet против AvlSet. Память
+// считает глобальный operator new: живые байты до и после построения.
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "../include/tiered-avl-set.hpp"
+#include "bench.hpp"
+
+using my_algorithms::AvlSet;
+using my_algorithms::TieredAvlSet;
+
+namespace {
+
+// Размер блока хранится перед ним, чтобы delete знал, сколько вычесть.
+size_t live_bytes = 0;
+
+constexpr size_t header = alignof(std::max_align_t);
+
+}  // namespace
+
+void *operator new(size_t size) {
+    auto *block = static_cast<char *>(std::malloc(size + header));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t *>(block) = size;
+    live_bytes += size;
+    return block + header;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr) {
+        char *block = static_cast<char *>(ptr) - header;
+        live_bytes -= *reinterpret_cast<size_t *>(block);
+        std::free(block);
+    }
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+// На каждые два ключа: вставка, удаление предыдущего и вставка.
+template <typename Set>
+double updates(Set &a, const std::vector<int> &keys) {
+    return bench::seconds([&] {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (i % 2 == 1) {
+                a.erase(keys[i - 1]);
+            }
+            a.insert(keys[i]);
+        }
+    });
+}
+
+}  // namespace
+
+int main() {
+    const size_t changes = 200'000;
+    const size_t ops = changes * 3 / 2;
+    for (size_t n : {size_t(1) << 16, size_t(1) << 20, size_t(1) << 22}) {
+        std::vector<int> keys = bench::random_keys(n, 1);
+        std::vector<int> fresh = bench::random_keys(changes, 2);
+
+        size_t before = live_bytes;
+        AvlSet<int> tree;
+        tree.insert_bulk(keys.begin(), keys.end());
+        size_t tree_bytes = live_bytes - before;
+
+        before = live_bytes;
+        TieredAvlSet<int> tiered(keys);
+        size_t tiered_bytes = live_bytes - before;
+
+        std::printf(
+            "%zu keys, bytes per key: AvlSet %.1f, TieredAvlSet %.1f\n",
+            tree.size(), double(tree_bytes) / double(tree.size()),
+            double(tiered_bytes) / double(tiered.size())
+        );
+
+        double tree_time = updates(tree, fresh);
+        tiered.set_max_delta(0);
+        before = live_bytes;
+        double tiered_time = updates(tiered, fresh);
+        size_t delta_bytes = live_bytes - before;
+        size_t delta = tiered.delta_size();
+        double compact_time = bench::seconds([&] { tiered.compact(); });
+
+        std::vector<int> more = bench::random_keys(changes, 3);
+        TieredAvlSet<int> automatic(keys);
+        double auto_time = updates(automatic, more);
+
+        bench::report("  update, AvlSet", tree_time, ops);
+        bench::report("  update, tiered, no compaction", tiered_time, ops);
+        std::printf(
+            "    delta %zu keys, %.1f bytes per key with the delta\n", delta,
+            double(tiered_bytes + delta_bytes) / double(tiered.size())
+        );
+        std::printf("  compact() %.1f ms\n", compact_time * 1e3);
+        bench::report("  update, tiered, max_delta 0.125", auto_time, ops);
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace my_algorithms {
+
+// Политики балансировки AvlSet. В поле hight узла хранится ранг, у пустого
+// поддерева он 0, у листа 1. rebalance(v, ops) вызывается для каждого узла
+// на пути от изменённого места к корню, когда поддеревья v уже исправлены
+// и размеры пересчитаны; возвращает новый корень поддерева. ops даёт
+// повороты (rotate_left/rotate_right поднимают правого/левого ребёнка и
+// пересчитывают только размеры) и on_rebalance() для статистики.
+//
+// height_ranked — ранг всегда равен высоте. Тогда ранг узла можно
+// вычислить по детям (так строятся деревья из отсортированных ключей), и
+// работают split/join по высотам, на которых стоит insert_bulk.
+
+// AVL: ранг — высота, высоты детей отличаются не больше чем на 1. Удаление
+// может потребовать поворотов на каждом уровне.
+struct AvlBalance {
+    static constexpr bool height_ranked = true;
+
+    template <typename Node, typename Ops>
+    static Node *rebalance(Node *v, const Ops &ops) {
+        fix(v);
+        int b = balance(v);
+        if (b == 2) {
+            ops.on_rebalance();
+            if (balance<Node>(v->left) < 0) {
+                v->left = rotate_left<Node>(v->left, ops);
+            }
+            return rotate_right(v, ops);
+        }
+        if (b == -2) {
+            ops.on_rebalance();
+            if (balance<Node>(v->right) > 0) {
+                v->right = rotate_right<Node>(v->right, ops);
+            }
+            return rotate_left(v, ops);
+        }
+        return v;
+    }
+
+private:
+    template <typename Node>
+    static size_t rank(const Node *v) noexcept {
+        return v ? v->hight : 0;
+    }
+
+    template <typename Node>
+    static int balance(const Node *v) noexcept {
+        return int(rank<Node>(v->left)) - int(rank<Node>(v->right));
+    }
+
+    template <typename Node>
+    static void fix(Node *v) noexcept {
+        v->hight = 1 + std::max(rank<Node>(v->left), rank<Node>(v->right));
+    }
+
+    template <typename Node, typename Ops>
+    static Node *rotate_right(Node *v, const Ops &ops) {
+        Node *u = ops.rotate_right(v);
+        fix(v);
+        fix(u);
+        return u;
+    }
+
+    template <typename Node, typename Ops>
+    static Node *rotate_left(Node *v, const Ops &ops) {
+        Node *u = ops.rotate_left(v);
+        fix(v);
+        fix(u);
+        return u;
+    }
+};
+
+// WAVL (Haeupler, Sen, Tarjan): разность рангов родителя и ребёнка 1 или
+// 2, у листа ранг 1. Вставка балансирует ровно как AVL, и без удалений
+// дерево остаётся AVL-деревом. Удаление делает не больше двух поворотов,
+// а суммарная работа по рангам — O(1) амортизированно на операцию; высота
+// не больше 2 log n.
+struct WavlBalance {
+    static constexpr bool height_ranked = false;
+
+    template <typename Node, typename Ops>
+    static Node *rebalance(Node *v, const Ops &ops) {
+        size_t dl = v->hight - rank<Node>(v->left);
+        size_t dr = v->hight - rank<Node>(v->right);
+        if (dl == 0 || dr == 0) {
+            return fix_insert(v, dl == 0, ops);
+        }
+        if (dl == 3 || dr == 3) {
+            return fix_erase(v, dl == 3, ops);
+        }
+        if (!v->left && !v->right) {
+            v->hight = 1;  // лист 2,2 после удаления детей
+        }
+        return v;
+    }
+
+private:
+    template <typename Node>
+    static size_t rank(const Node *v) noexcept {
+        return v ? v->hight : 0;
+    }
+
+    template <typename Node>
+    static Node *child(Node *v, bool left) noexcept {
+        return left ? v->left : v->right;
+    }
+
+    template <typename Node>
+    static void set_child(Node *v, bool left, Node *c) noexcept {
+        (left ? v->left : v->right) = c;
+    }
+
+    // Поднимает ребёнка v с указанной стороны на место v.
+    template <typename Node, typename Ops>
+    static Node *lift(Node *v, bool left, const Ops &ops) {
+        return left ? ops.rotate_right(v) : ops.rotate_left(v);
+    }
+
+    // Ребёнок с одной стороны догнал v по рангу.
+    template <typename Node, typename Ops>
+    static Node *fix_insert(Node *v, bool left, const Ops &ops) {
+        if (v->hight - rank<Node>(child(v, !left)) == 1) {
+            ++v->hight;  // нарушение уходит к родителю
+            return v;
+        }
+        ops.on_rebalance();
+        Node *x = child(v, left);
+        Node *z = child(x, !left);
+        if (x->hight - rank<Node>(z) == 2) {
+            --v->hight;
+            return lift(v, left, ops);
+        }
+        set_child(v, left, lift(x, !left, ops));
+        ++z->hight;
+        --x->hight;
+        --v->hight;
+        return lift(v, left, ops);
+    }
+
+    // Ребёнок с одной стороны отстал от v на 3.
+    template <typename Node, typename Ops>
+    static Node *fix_erase(Node *v, bool left, const Ops &ops) {
+        Node *y = child(v, !left);
+        if (v->hight - y->hight == 2) {
+            --v->hight;  // нарушение уходит к родителю
+            return v;
+        }
+        Node *outer = child(y, !left);
+        Node *inner = child(y, left);
+        size_t d_outer = y->hight - rank<Node>(outer);
+        size_t d_inner = y->hight - rank<Node>(inner);
+        if (d_outer == 2 && d_inner == 2) {
+            --y->hight;
+            --v->hight;
+            return v;
+        }
+        ops.on_rebalance();
+        if (d_outer == 1) {
+            Node *res = lift(v, !left, ops);
+            ++y->hight;
+            --v->hight;
+            if (!v->left && !v->right) {
+                v->hight = 1;
+            }
+            return res;
+        }
+        set_child(v, !left, lift(y, left, ops));
+        Node *res = lift(v, !left, ops);
+        inner->hight += 2;
+        --y->hight;
+        v->hight -= 2;
+        return res;
+    }
+};
+
+}  // namespace my_algorithms
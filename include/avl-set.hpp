@@ -1,21 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "avl-balance.hpp"
+#include "avl-stats.hpp"
+#include "counting-bloom-filter.hpp"
+#include "hash-index.hpp"
+#include "hot-key-cache.hpp"
+#include "epoch-reclamation.hpp"
+#include "key-codec.hpp"
+
 namespace my_algorithms {
+
+// Политики для insert_bulk и parallel_*. Свои, а не из <execution>: с
+// установленным TBB libstdc++ тянет из <execution> его функции, и любая
+// программа с AvlSet без -ltbb переставала собираться. Параллельная работа
+// всё равно идёт на своих потоках (detail::parallel_for).
+namespace execution {
+
+struct sequenced_policy {};
+struct parallel_policy {};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+
+}  // namespace execution
+
+template <typename T>
+inline constexpr bool is_execution_policy_v =
+    std::is_same_v<std::remove_cvref_t<T>, execution::sequenced_policy> ||
+    std::is_same_v<std::remove_cvref_t<T>, execution::parallel_policy>;
+
+namespace detail {
+
+// Компаратор сам возвращает порядок (std::compare_three_way и т.п.).
+template <typename Compare, typename T>
+concept ThreeWayCompare = requires(const Compare &comp, const T &a) {
+    { comp(a, a) } -> std::convertible_to<std::partial_ordering>;
+};
+
+// std::less над типом с operator<=> можно заменить одним вызовом <=>.
+template <typename Compare, typename T>
+inline constexpr bool is_builtin_less_v =
+    std::three_way_comparable<T> &&
+    (std::is_same_v<Compare, std::less<T>> ||
+     std::is_same_v<Compare, std::less<>>);
+
+// Фильтр и хеш-индекс опираются на std::hash ключа, поэтому годятся только
+// там, где эквивалентность по компаратору совпадает с ==.
+template <typename Compare, typename T>
+inline constexpr bool is_hash_consistent_v =
+    requires(const T &value) {
+        { std::hash<T>()(value) } -> std::convertible_to<size_t>;
+    } &&
+    (std::is_same_v<Compare, std::less<T>> ||
+     std::is_same_v<Compare, std::less<>> ||
+     std::is_same_v<Compare, std::greater<T>> ||
+     std::is_same_v<Compare, std::greater<>> ||
+     std::is_same_v<Compare, std::compare_three_way>);
+
+// Для std::string с лексикографическим сравнением первые 8 байт ключа
+// хранятся в узле в виде big-endian числа: если префиксы различаются,
+// порядок решается без обращения к буферу строки.
+template <typename T, typename Compare>
+inline constexpr bool is_prefix_cached_v =
+    std::is_same_v<T, std::string> &&
+    (std::is_same_v<Compare, std::less<std::string>> ||
+     std::is_same_v<Compare, std::less<>> ||
+     std::is_same_v<Compare, std::compare_three_way>);
+
+template <typename T, typename Compare, bool = is_prefix_cached_v<T, Compare>>
+struct KeyPrefix {
+    struct type {
+        bool operator==(const type &) const = default;
+    };
+
+    static type make(const T &) noexcept {
+        return {};
+    }
+};
+
+template <typename T, typename Compare>
+struct KeyPrefix<T, Compare, true> {
+    using type = std::uint64_t;
+
+    static type make(const T &value) noexcept {
+        type res = 0;
+        size_t n = std::min<size_t>(value.size(), sizeof(type));
+        for (size_t i = 0; i < n; ++i) {
+            res |= static_cast<type>(static_cast<unsigned char>(value[i]))
+                   << (8 * (sizeof(type) - 1 - i));
+        }
+        return res;
+    }
+};
+
+// Аллокатор выделяет только по одному объекту (IndexAllocator): compact()
+// тогда берёт ячейки по одной, а не одним блоком.
+template <typename Allocator>
+inline constexpr bool allocates_single_v = requires {
+    requires Allocator::allocates_single::value;
+};
+
+// Меньше этого числа ключей на поток параллелить нет смысла.
+inline constexpr size_t parallel_grain = 1 << 14;
+
+template <typename ExecutionPolicy>
+size_t worker_count(const ExecutionPolicy &, size_t n) {
+    using Policy = std::remove_cvref_t<ExecutionPolicy>;
+    if constexpr (std::is_same_v<Policy, execution::sequenced_policy>) {
+        return 1;
+    } else {
+        size_t hw = std::max(1U, std::thread::hardware_concurrency());
+        return std::clamp<size_t>(n / parallel_grain, 1, hw);
+    }
+}
+
+// Делит [0, n) на workers кусков и обрабатывает каждый в своём потоке.
+template <typename F>
+void parallel_for(size_t n, size_t workers, F f) {
+    if (workers <= 1) {
+        f(0, n);
+        return;
+    }
+    std::vector<std::future<void>> tasks;
+    for (size_t w = 1; w < workers; ++w) {
+        tasks.push_back(std::async(
+            std::launch::async, f, n * w / workers, n * (w + 1) / workers
+        ));
+    }
+    f(0, n / workers);
+    for (auto &task : tasks) {
+        task.get();
+    }
+}
+
+// Выполняет f и g, f — в отдельном потоке, если parallel.
+template <typename F, typename G>
+void fork_join(bool parallel, F f, G g) {
+    if (!parallel) {
+        f();
+        g();
+        return;
+    }
+    auto task = std::async(std::launch::async, f);
+    g();
+    task.get();
+}
+
+template <typename RandomIt, typename Less>
+void parallel_sort(RandomIt first, RandomIt last, Less less, size_t workers) {
+    size_t n = last - first;
+    if (workers <= 1) {
+        std::sort(first, last, less);
+        return;
+    }
+    std::vector<size_t> bounds(workers + 1);
+    for (size_t w = 0; w <= workers; ++w) {
+        bounds[w] = n * w / workers;
+    }
+    parallel_for(workers, workers, [&](size_t lo, size_t hi) {
+        for (size_t w = lo; w < hi; ++w) {
+            std::sort(first + bounds[w], first + bounds[w + 1], less);
+        }
+    });
+    // Попарно сливаем отсортированные куски, пока не останется один.
+    for (size_t step = 1; step < workers; step *= 2) {
+        size_t merges = (workers + 2 * step - 1) / (2 * step);
+        parallel_for(merges, merges, [&](size_t lo, size_t hi) {
+            for (size_t m = lo; m < hi; ++m) {
+                size_t a = 2 * step * m;
+                size_t b = std::min(a + step, workers);
+                size_t c = std::min(a + 2 * step, workers);
+                std::inplace_merge(
+                    first + bounds[a], first + bounds[b], first + bounds[c],
+                    less
+                );
+            }
+        });
+    }
+}
+
+}  // namespace detail
+
+template <typename T, typename Compare, typename Allocator>
+class SeqlockAvlSet;
+
 template <
     typename T,
     typename Compare = std::less<T>,
-    typename Allocator = std::allocator<T>>
+    typename Allocator = std::allocator<T>,
+    typename Stats = NullStats,
+    typename Balance = AvlBalance>
 class AvlSet {
+    template <typename, typename, typename>
+    friend class SeqlockAvlSet;
+
+    using KeyPrefix = detail::KeyPrefix<T, Compare>;
+    using Prefix = typename KeyPrefix::type;
+
+    struct Node;
+    // Тип ссылок между узлами берётся из аллокатора: Node * для обычного,
+    // OffsetPtr<Node> для SegmentAllocator (дерево в разделяемой памяти).
+    using NodePtr = typename std::pointer_traits<
+        typename std::allocator_traits<Allocator>::void_pointer>::
+        template rebind<Node>;
+
     struct Node {
         T value;
-        size_t hight;
+        [[no_unique_address]] Prefix prefix;
+        bool dead;  // надгробие ленивого удаления
+        size_t hight;  // ранг политики Balance, у AVL — высота
         size_t size;
-        Node *parent;
-        Node *left;
-        Node *right;
-        Node *next;
-        Node *prev;
+        NodePtr parent;
+        NodePtr left;
+        NodePtr right;
+        NodePtr next;
+        NodePtr prev;
 
         explicit Node(const T &value) noexcept
             : value(value),
+              prefix(KeyPrefix::make(value)),
+              dead(false),
+              hight(1),
+              size(1),
+              parent(nullptr),
+              left(nullptr),
+              right(nullptr),
+              next(nullptr),
+              prev(nullptr) {
+        }
+
+        explicit Node(T &&value) noexcept
+            : value(std::move(value)),
+              prefix(KeyPrefix::make(this->value)),
+              dead(false),
               hight(1),
               size(1),
               parent(nullptr),
@@ -33,10 +269,10 @@ class AvlSet {
         using pointer = T *;
         using reference = T &;
 
-        iterator() : node_(nullptr) {
+        iterator() : node_(nullptr), set_(nullptr) {
         }
 
-        explicit iterator(Node *node) : node_(node) {
+        iterator(Node *node, const AvlSet *set) : node_(node), set_(set) {
         }
 
         reference operator*() const noexcept {
@@ -48,7 +284,7 @@ class AvlSet {
         }
 
         iterator operator++() {
-            node_ = node_->next;
+            node_ = live_(node_->next);
             return *this;
         }
 
@@ -58,14 +294,16 @@ class AvlSet {
             return tmp;
         }
 
+        // --end() — последний элемент: у end() нет узла, поэтому итератор
+        // помнит своё множество.
         iterator operator--() {
-            node_ = node_->prev;
+            node_ = node_ ? live_back_(node_->prev) : set_->last_();
             return *this;
         }
 
         iterator operator--(int) {
             iterator tmp = *this;
-            node_ = node_->prev;
+            --(*this);
             return tmp;
         }
 
@@ -79,7 +317,8 @@ class AvlSet {
 
     private:
         Node *node_;
-        friend struct AvlSet<T>;
+        const AvlSet *set_;
+        friend class AvlSet;
     };
 
 public:
@@ -106,18 +345,19 @@ public:
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
     iterator begin() const {
+        sync_();
         Node *v = root_;
         if (!v) {
-            return iterator(nullptr);
+            return iterator(nullptr, this);
         }
         while (v->left) {
             v = v->left;
         }
-        return iterator(v);
+        return iterator(live_(v), this);
     }
 
     iterator end() const {
-        return iterator(nullptr);
+        return iterator(nullptr, this);
     }
 
     reverse_iterator rbegin() noexcept {
@@ -145,15 +385,18 @@ public:
     }
 
     iterator find(const T &value) {
-        return iterator(find_(root_, value));
+        sync_();
+        return iterator(lookup_(value), this);
     }
 
     const_iterator find(const T &value) const {
-        return const_iterator(find_(root_, value));
+        sync_();
+        return const_iterator(lookup_(value), this);
     }
 
     bool contains(const T &value) const {
-        return find_(root_, value) != nullptr;
+        sync_();
+        return lookup_(value) != nullptr;
     }
 
     size_t count(const T &value) const {
@@ -161,17 +404,21 @@ public:
     }
 
     iterator lower_bound(const T &value) {
+        sync_();
         Node *res = nullptr;
         Node *v = root_;
-        while (v) {
-            if (!comp_(v->value, value)) {
+        Probe key = probe(value);
+        size_t depth = 0;
+        for (; v; ++depth) {
+            if (!less_(v, key)) {
                 res = v;
                 v = v->left;
             } else {
                 v = v->right;
             }
         }
-        return iterator(res);
+        stats_.on_descent(depth);
+        return iterator(live_(res), this);
     }
 
     const_iterator lower_bound(const T &value) const {
@@ -179,17 +426,21 @@ public:
     }
 
     iterator upper_bound(const T &value) {
+        sync_();
         Node *res = nullptr;
         Node *v = root_;
-        while (v) {
-            if (comp_(value, v->value)) {
+        Probe key = probe(value);
+        size_t depth = 0;
+        for (; v; ++depth) {
+            if (less_(key, v)) {
                 res = v;
                 v = v->left;
             } else {
                 v = v->right;
             }
         }
-        return iterator(res);
+        stats_.on_descent(depth);
+        return iterator(live_(res), this);
     }
 
     const_iterator upper_bound(const T &value) const {
@@ -206,10 +457,203 @@ public:
         return {lower_bound(value), upper_bound(value)};
     }
 
+    // Поиск от подсказки: от hint поднимаемся по parent, пока поддерево не
+    // накроет ответ, и спускаемся обратно. Стоит O(log d), где d —
+    // расстояние от hint до ответа; от end() — обычный спуск от корня.
+    iterator lower_bound(const_iterator hint, const T &value) const {
+        sync_();
+        return iterator(finger_(hint.node_, probe(value)), this);
+    }
+
+    iterator find(const_iterator hint, const T &value) const {
+        sync_();
+        Probe key = probe(value);
+        Node *v = finger_(hint.node_, key);
+        return iterator(v && !less_(key, v) ? v : nullptr, this);
+    }
+
+    // Курсор для совместного обхода множества и отсортированного потока
+    // ключей: seek(key) переходит к первому элементу не меньше key, начиная
+    // поиск с текущей позиции. Ключи могут идти и назад, но выгода — когда
+    // они близки к предыдущим.
+    class Cursor {
+    public:
+        explicit Cursor(const AvlSet &set) : set_(&set), it_(set.begin()) {
+        }
+
+        iterator seek(const T &key) {
+            it_ = set_->lower_bound(it_, key);
+            return it_;
+        }
+
+        iterator position() const noexcept {
+            return it_;
+        }
+
+        bool at_end() const noexcept {
+            return it_ == set_->end();
+        }
+
+        const T &operator*() const noexcept {
+            return *it_;
+        }
+
+        Cursor &operator++() {
+            ++it_;
+            return *this;
+        }
+
+    private:
+        const AvlSet *set_;
+        iterator it_;
+    };
+
+    Cursor cursor() const {
+        return Cursor(*this);
+    }
+
     void swap(AvlSet &other) noexcept {
         std::swap(root_, other.root_);
         std::swap(comp_, other.comp_);
         std::swap(allocator_, other.allocator_);
+        std::swap(domain_, other.domain_);
+        std::swap(ext_, other.ext_);
+    }
+
+    // Подключает отложенное освобождение узлов: erase и clear отдают узлы
+    // в domain->retire(), а читатели под EpochGuard не увидят освобождённой
+    // памяти. Домен должен жить дольше множества.
+    void set_epoch_domain(EpochDomain *domain) noexcept {
+        domain_ = domain;
+    }
+
+    EpochDomain *epoch_domain() const noexcept {
+        return domain_;
+    }
+
+    // Включает фильтр Блума перед деревом: find/contains для отсутствующих
+    // ключей в большинстве случаев отвечают по одной кеш-линии фильтра.
+    // Фильтр рассчитан на вдвое большее число ключей и перестраивается за
+    // O(n), когда множество перерастает его.
+    void enable_filter(double fp_rate = 0.01)
+        requires detail::is_hash_consistent_v<Compare, T>
+    {
+        rebuild_filter_(std::max<size_t>(2 * size(), 1024), fp_rate);
+    }
+
+    void disable_filter() noexcept {
+        if (ext_) {
+            ext_->filter.reset();
+        }
+    }
+
+    const CountingBloomFilter *filter() const noexcept {
+        return filter_();
+    }
+
+    // Хеш-индекс ключ -> узел рядом с деревом: find/contains за O(1) в
+    // среднем и возвращают обычный итератор, упорядоченные операции
+    // по-прежнему идут по дереву. Стоит 16 байт на ячейку при заполнении
+    // не выше половины, то есть 32-64 байта на ключ.
+    void enable_hash_index()
+        requires detail::is_hash_consistent_v<Compare, T>
+    {
+        auto index = std::make_unique<HashIndex<Node>>(size());
+        for (Node *v = begin().node_; v; v = live_(v->next)) {
+            index->insert(hash_(v->value), v);
+        }
+        extension_().index.swap(index);
+    }
+
+    void disable_hash_index() noexcept {
+        if (ext_) {
+            ext_->index.reset();
+        }
+    }
+
+    const HashIndex<Node> *hash_index() const noexcept {
+        return index_();
+    }
+
+    // Кеш последних найденных узлов перед деревом: при перекошенном доступе
+    // find/contains для горячих ключей не спускаются от корня. Узлы при
+    // поворотах не переезжают, так что кеш чистится только при удалении
+    // узла и при compact(). С включённым хеш-индексом не используется.
+    void enable_hot_cache(size_t entries = 4096)
+        requires detail::is_hash_consistent_v<Compare, T>
+    {
+        extension_().cache = std::make_unique<HotKeyCache<Node>>(entries);
+    }
+
+    void disable_hot_cache() noexcept {
+        if (ext_) {
+            ext_->cache.reset();
+        }
+    }
+
+    const HotKeyCache<Node> *hot_cache() const noexcept {
+        return cache_();
+    }
+
+    // Ленивое удаление: erase только ставит на узел надгробие и вычитает
+    // его из размеров поддеревьев на пути к корню, без поворотов. Поиск и
+    // итераторы надгробия пропускают, size() остаётся точным. Когда
+    // надгробий больше max_dead от всех узлов, дерево перестраивается из
+    // живых узлов за O(n) одним проходом. Итераторы на удалённые элементы
+    // остаются пригодными для ++ до перестройки.
+    void enable_lazy_erase(double max_dead = 0.25) {
+        if (!(max_dead > 0 && max_dead < 1)) {
+            throw std::invalid_argument("AvlSet: bad max_dead");
+        }
+        extension_().max_dead = max_dead;
+    }
+
+    void disable_lazy_erase() {
+        purge();
+        if (ext_) {
+            ext_->max_dead = 0;
+        }
+    }
+
+    // Сразу убирает все надгробия.
+    void purge() {
+        if (!tombstones()) {
+            return;
+        }
+        abandon_compaction_();
+        std::vector<Node *> live;
+        live.reserve(get_size(root_));
+        Node *v = root_;
+        while (v->left) {
+            v = v->left;
+        }
+        while (v) {
+            Node *next = v->next;
+            if (v->dead) {
+                free_node(v);
+            } else {
+                live.push_back(v);
+            }
+            v = next;
+        }
+        ext_->tombstones = 0;
+        root_ = relink_(live, 0, live.size());
+        if (root_) {
+            root_->parent = nullptr;
+        }
+        for (size_t i = 0; i < live.size(); ++i) {
+            live[i]->prev = i ? live[i - 1] : nullptr;
+            live[i]->next = i + 1 < live.size() ? live[i + 1] : nullptr;
+        }
+    }
+
+    size_t tombstones() const noexcept {
+        return ext_ ? ext_->tombstones : 0;
+    }
+
+    // Счётчики политики Stats; с NullStats — пустой объект.
+    const Stats &stats() const noexcept {
+        return stats_;
     }
 
     key_compare key_comp() const {
@@ -225,36 +669,350 @@ public:
     }
 
     void insert(const T &value) {
-        root_ = insert_(root_, value);
-        update_prev_and_next(find_(root_, value));
+        if (ext_ && ext_->max_pending) {
+            Extension &ext = *ext_;
+            ext.pending.push_back(value);
+            if (ext.pending.size() >= ext.max_pending) {
+                ext.flusher(*this);
+            }
+            return;
+        }
+        insert_one_(value);
+    }
+
+    // Буферная вставка: insert только дописывает ключ в неупорядоченный
+    // буфер за O(1). Первое чтение (поиск, итерация, size() и т.п.), erase
+    // или переполнение буфера (max_pending ключей) вливает буфер в дерево
+    // одной пачкой через insert_bulk. Пока буфер не пуст, константные
+    // методы меняют дерево, и звать их из нескольких потоков нельзя.
+    void enable_buffered_insert(size_t max_pending = 1 << 20) {
+        if (max_pending == 0) {
+            throw std::invalid_argument("AvlSet: bad max_pending");
+        }
+        Extension &ext = extension_();
+        ext.max_pending = max_pending;
+        ext.flusher = &AvlSet::flush_pending_;
+    }
+
+    void disable_buffered_insert() {
+        flush();
+        if (ext_) {
+            ext_->max_pending = 0;
+        }
+    }
+
+    void flush() {
+        sync_();
+    }
+
+    size_t pending() const noexcept {
+        return ext_ ? ext_->pending.size() : 0;
+    }
+
+    // Вставка пачки неотсортированных ключей: сортировка, удаление дублей,
+    // параллельная сборка сбалансированного поддерева и слияние с деревом
+    // через split/join. Для par-политик аллокатор должен быть без состояния.
+    template <typename InputIt, typename ExecutionPolicy>
+        requires is_execution_policy_v<ExecutionPolicy>
+    void insert_bulk(InputIt first, InputIt last, ExecutionPolicy &&policy) {
+        std::vector<T> batch(first, last);
+        if (ext_) {
+            std::vector<T> &pending = ext_->pending;
+            batch.insert(
+                batch.end(), std::make_move_iterator(pending.begin()),
+                std::make_move_iterator(pending.end())
+            );
+            pending.clear();
+        }
+        insert_batch_(std::move(batch), policy);
+    }
+
+    template <typename InputIt>
+    void insert_bulk(InputIt first, InputIt last) {
+        insert_bulk(first, last, execution::seq);
     }
 
     void erase(const T &value) {
-        root_ = erase_(root_, value);
+        sync_();
+        Node *found = nullptr;
+        if (index_()) {
+            found = index_find_(value);
+            if (!found) {
+                return;
+            }
+            index_erase_(found);
+        }
+        if (ext_ && ext_->max_dead > 0) {
+            if (!found) {
+                found = find_live_(probe(value));
+            }
+            if (found) {
+                bury_(found);
+            }
+            return;
+        }
+        abandon_compaction_();
+        size_t before = get_size(root_);
+        descent_([&] { root_ = erase_(root_, probe(value)); });
+        if (filter_() && get_size(root_) < before) {
+            filter_remove_(value);
+        }
+    }
+
+    // Вызывает fn для каждого элемента. Дерево делится по рангам на равные
+    // куски, каждый кусок обходится по next в своём потоке; порядок вызовов
+    // между кусками не определён.
+    template <typename ExecutionPolicy, typename F>
+        requires is_execution_policy_v<ExecutionPolicy>
+    void parallel_for_each(ExecutionPolicy &&policy, F fn) const {
+        size_t n = size();
+        detail::parallel_for(
+            n, detail::worker_count(policy, n),
+            [&](size_t lo, size_t hi) {
+                Node *v = select_(lo);
+                for (size_t i = lo; i < hi; ++i, v = live_(v->next)) {
+                    fn(static_cast<const T &>(v->value));
+                }
+            }
+        );
+    }
+
+    // Как std::transform_reduce: reduce должна быть ассоциативной, частичные
+    // результаты кусков сворачиваются слева направо.
+    template <
+        typename ExecutionPolicy,
+        typename R,
+        typename BinaryOp,
+        typename UnaryOp>
+        requires is_execution_policy_v<ExecutionPolicy>
+    R parallel_reduce(
+        ExecutionPolicy &&policy,
+        R init,
+        BinaryOp reduce,
+        UnaryOp transform
+    ) const {
+        size_t n = size();
+        if (n == 0) {
+            return init;
+        }
+        size_t workers = detail::worker_count(policy, n);
+        std::vector<std::optional<R>> partial(workers);
+        detail::parallel_for(workers, workers, [&](size_t lo, size_t hi) {
+            for (size_t w = lo; w < hi; ++w) {
+                size_t first = n * w / workers;
+                size_t last = n * (w + 1) / workers;
+                Node *v = select_(first);
+                R acc = transform(static_cast<const T &>(v->value));
+                for (size_t i = first + 1; i < last; ++i) {
+                    v = live_(v->next);
+                    acc = reduce(std::move(acc), transform(v->value));
+                }
+                partial[w].emplace(std::move(acc));
+            }
+        });
+        for (auto &part : partial) {
+            init = reduce(std::move(init), std::move(*part));
+        }
+        return init;
+    }
+
+    template <typename ExecutionPolicy, typename R, typename BinaryOp>
+        requires is_execution_policy_v<ExecutionPolicy>
+    R parallel_reduce(ExecutionPolicy &&policy, R init, BinaryOp reduce)
+        const {
+        return parallel_reduce(
+            std::forward<ExecutionPolicy>(policy), std::move(init), reduce,
+            [](const T &value) -> const T & { return value; }
+        );
     }
 
     void print() {
+        sync_();
         print_(root_);
     }
 
-    size_t size() const noexcept {
+    // Формат: "AVLS", версия, id кодека, varint числа ключей, затем ключи по
+    // порядку, каждый закодирован относительно предыдущего.
+    static constexpr char serial_magic[4] = {'A', 'V', 'L', 'S'};
+    static constexpr std::uint8_t serial_version = 1;
+
+    template <typename Codec = KeyCodec<T>>
+    void serialize(std::ostream &out, const Codec &codec = Codec()) const {
+        sync_();
+        out.write(serial_magic, sizeof(serial_magic));
+        out.put(static_cast<char>(serial_version));
+        out.put(static_cast<char>(Codec::id));
+        write_varint(out, size());
+        const T *prev = nullptr;
+        for (const T &value : *this) {
+            codec.encode(out, value, prev);
+            prev = &value;
+        }
+        if (!out) {
+            throw std::runtime_error("AvlSet::serialize: write failed");
+        }
+    }
+
+    // Заменяет содержимое ключами из потока. Дерево строится за O(n) прямо
+    // по мере чтения, без промежуточного массива.
+    template <typename Codec = KeyCodec<T>>
+    void deserialize(std::istream &in, const Codec &codec = Codec()) {
+        char header[sizeof(serial_magic) + 2];
+        read_exact(in, header, sizeof(header));
+        if (!std::equal(
+                serial_magic, serial_magic + sizeof(serial_magic), header
+            )) {
+            throw std::runtime_error("AvlSet::deserialize: bad magic");
+        }
+        if (static_cast<std::uint8_t>(header[4]) != serial_version) {
+            throw std::runtime_error("AvlSet::deserialize: unknown version");
+        }
+        if (static_cast<std::uint8_t>(header[5]) != Codec::id) {
+            throw std::runtime_error("AvlSet::deserialize: codec mismatch");
+        }
+        size_t n = read_varint(in);
+        Node *last = nullptr;
+        Node *tree = nullptr;
+        try {
+            tree = read_tree_(in, codec, n, last);
+        } catch (...) {
+            // Все уже созданные узлы связаны через prev.
+            while (last) {
+                Node *prev = last->prev;
+                NodeTraits::destroy(allocator_, last);
+                deallocate_node_(allocator_, last);
+                last = prev;
+            }
+            throw;
+        }
+        if (tree) {
+            tree->parent = nullptr;
+        }
+        clear();
+        root_ = tree;
+        if (const CountingBloomFilter *filter = filter_()) {
+            rebuild_filter_(
+                std::max<size_t>(2 * size(), 1024), filter->fp_rate()
+            );
+        }
+        if (index_()) {
+            for (Node *v = begin().node_; v; v = v->next) {
+                index_add_(v);
+            }
+        }
+    }
+
+    size_t size() const {
+        sync_();
         return get_size(root_);
     }
 
-    bool empty() const noexcept {
+    bool empty() const {
+        sync_();
         return get_size(root_) == 0;
     }
 
     void clear() {
+        abandon_compaction_();
+        if (ext_) {
+            ext_->pending.clear();
+            ext_->tombstones = 0;
+        }
+        // Кеш сбрасывается целиком, а не по одному узлу.
+        std::unique_ptr<HotKeyCache<Node>> cache;
+        if (ext_) {
+            cache = std::move(ext_->cache);
+        }
         destroy(root_);
         root_ = nullptr;
+        if (cache) {
+            cache->clear();
+            ext_->cache = std::move(cache);
+        }
+        if (CountingBloomFilter *filter = filter_()) {
+            filter->clear();
+        }
+        if (HashIndex<Node> *index = index_()) {
+            index->clear();
+        }
+    }
+
+    // Переносит узлы в один непрерывный блок в порядке обхода, чтобы проход
+    // по next шёл по памяти подряд. За вызов переносится не больше max_nodes
+    // узлов; возвращает true, когда перенесены все. insert/erase/clear
+    // прерывают начатое уплотнение, следующий вызов начнёт заново.
+    // Старые узлы возвращаются аллокатору. Итераторы становятся
+    // недействительными. Аллокатор, выдающий узлы по одному
+    // (IndexAllocator), отдаёт все ячейки в первом вызове; подряд они лягут,
+    // если подряд их выдаёт аллокатор. С EpochDomain значения копируются:
+    // читатели могут ещё держать старые узлы.
+    bool compact(size_t max_nodes = SIZE_MAX) {
+        if (!ext_ || !ext_->compact_next) {
+            if constexpr (!std::is_copy_constructible_v<T>) {
+                if (domain_) {
+                    throw std::logic_error(
+                        "AvlSet::compact: move-only keys with an epoch domain"
+                    );
+                }
+            }
+            purge();
+            size_t n = size();
+            if (n == 0) {
+                return true;
+            }
+            start_compaction_(n);
+        }
+        Extension &ext = *ext_;
+        for (size_t moved = 0; ext.compact_next && moved < max_nodes;
+             ++moved) {
+            Node *v = ext.compact_next;
+            Node *cell = compact_cell_();
+            relocate_(v, cell);
+            ++ext.compact_filled;
+            ext.compact_next = cell->next;
+            if constexpr (!detail::allocates_single_v<NodeAllocator>) {
+                // Ссылку на Slab между итерациями держать нельзя:
+                // освобождение старых блоков сдвигает элементы slabs.
+                ++find_slab_(ext.compact_slab)->live;
+            }
+        }
+        if (ext.compact_next) {
+            return false;
+        }
+        ext.compact_slab = nullptr;
+        std::vector<Node *>().swap(ext.compact_cells);
+        return true;
+    }
+
+    void shrink_to_fit() {
+        compact();
     }
 
     AvlSet() {
     }
 
+    explicit AvlSet(const Compare &comp) : comp_(comp) {
+    }
+
+    explicit AvlSet(const Allocator &allocator) : allocator_(allocator) {
+    }
+
+    AvlSet(const Compare &comp, const Allocator &allocator)
+        : comp_(comp), allocator_(allocator) {
+    }
+
     ~AvlSet() {
+        abandon_compaction_();
+        if (ext_) {
+            ext_->cache.reset();
+        }
         destroy(root_);
+        // Отложенные удалители ссылаются на this. Читателей у удаляемого
+        // множества уже нет, поэтому свои узлы освобождаются сразу, а чужие
+        // остаются в домене.
+        if (domain_) {
+            domain_->purge(this);
+        }
     }
 
     friend bool operator==(const AvlSet &lhs, const AvlSet &rhs) {
@@ -269,7 +1027,8 @@ public:
 
     friend bool operator<(const AvlSet &lhs, const AvlSet &rhs) {
         return std::lexicographical_compare(
-            lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), lhs.comp_
+            lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+            [&lhs](const T &a, const T &b) { return lhs.less_(a, b); }
         );
     }
 
@@ -286,6 +1045,87 @@ public:
     }
 
 private:
+    // Один вызов компаратора на узел: <0, 0 или >0, как у operator<=>.
+    int compare_(const T &a, const T &b) const {
+        if constexpr (detail::ThreeWayCompare<Compare, T>) {
+            auto c = comp_(a, b);
+            return c < 0 ? -1 : (c > 0 ? 1 : 0);
+        } else if constexpr (detail::is_builtin_less_v<Compare, T>) {
+            auto c = a <=> b;
+            return c < 0 ? -1 : (c > 0 ? 1 : 0);
+        } else {
+            if (comp_(a, b)) {
+                return -1;
+            }
+            return comp_(b, a) ? 1 : 0;
+        }
+    }
+
+    bool less_(const T &a, const T &b) const {
+        if constexpr (detail::ThreeWayCompare<Compare, T>) {
+            return comp_(a, b) < 0;
+        } else {
+            return comp_(a, b);
+        }
+    }
+
+    // Искомый ключ вместе с заранее посчитанным префиксом.
+    struct Probe {
+        const T &value;
+        Prefix prefix;
+    };
+
+    static Probe probe(const T &value) noexcept {
+        return {value, KeyPrefix::make(value)};
+    }
+
+    int compare_(const Probe &key, const Node *v) const {
+        stats_.on_compare();
+        if constexpr (detail::is_prefix_cached_v<T, Compare>) {
+            if (key.prefix != v->prefix) {
+                return key.prefix < v->prefix ? -1 : 1;
+            }
+        }
+        return compare_(key.value, v->value);
+    }
+
+    bool less_(const Probe &key, const Node *v) const {
+        stats_.on_compare();
+        if constexpr (detail::is_prefix_cached_v<T, Compare>) {
+            if (key.prefix != v->prefix) {
+                return key.prefix < v->prefix;
+            }
+        }
+        return less_(key.value, v->value);
+    }
+
+    bool less_(const Node *v, const Probe &key) const {
+        stats_.on_compare();
+        if constexpr (detail::is_prefix_cached_v<T, Compare>) {
+            if (key.prefix != v->prefix) {
+                return v->prefix < key.prefix;
+            }
+        }
+        return less_(v->value, key.value);
+    }
+
+    // k-й по порядку узел (с нуля) за O(log n) по размерам поддеревьев.
+    Node *select_(size_t k) const noexcept {
+        Node *v = root_;
+        while (v) {
+            size_t left = get_size(v->left);
+            if (k < left) {
+                v = v->left;
+            } else if (k == left && !v->dead) {
+                return v;
+            } else {
+                k -= left + !v->dead;
+                v = v->right;
+            }
+        }
+        return nullptr;
+    }
+
     Node *get_next_node(Node *v) const noexcept {
         if (!v) {
             return nullptr;
@@ -327,40 +1167,570 @@ private:
         }
         destroy(v->left);
         destroy(v->right);
-        NodeTraits::destroy(allocator_, v);
-        NodeTraits::deallocate(allocator_, v, 1);
+        free_node(v);
     }
 
-    size_t get_hight(Node *v) const noexcept {
-        return v ? v->hight : 0;
+    // С подключённым EpochDomain узел освобождается только после того,
+    // как из эпохи выйдут все читатели, которые могли его видеть.
+    void free_node(Node *v) {
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            if (HotKeyCache<Node> *cache = cache_()) {
+                cache->forget(hash_(v->value), v);
+            }
+        }
+        if (domain_) {
+            domain_->retire(v, &AvlSet::delete_retired, this);
+            return;
+        }
+        release_node_(v);
     }
 
-    size_t get_size(Node *v) const noexcept {
-        return v ? v->size : 0;
+    static void delete_retired(void *set, void *node) {
+        static_cast<AvlSet *>(set)->release_node_(static_cast<Node *>(node));
     }
 
-    void update(Node *v) noexcept {
-        v->size = 1 + get_size(v->left) + get_size(v->right);
-        v->hight = 1 + std::max(get_hight(v->left), get_hight(v->right));
+    static std::uint64_t hash_(const T &value) {
+        return CountingBloomFilter::mix(std::hash<T>()(value));
     }
 
-    Node *right_rotate(Node *v) noexcept {
-        Node *temp = v->left;
-        v->left = temp->right;
-        if (v->left) {
-            v->left->parent = v;
+    // Перед чтением вливает буфер буферной вставки.
+    void sync_() const {
+        if (ext_ && !ext_->pending.empty()) {
+            ext_->flusher(*const_cast<AvlSet *>(this));
         }
-        temp->right = v;
+    }
 
-        temp->parent = v->parent;
-        v->parent = temp;
+    // Вызывается только через Extension::flusher: так сортировка буфера
+    // (ей нужно перемещающее присваивание T) инстанцируется лишь у
+    // множеств, где буферная вставка включалась.
+    static void flush_pending_(AvlSet &set) {
+        std::vector<T> batch;
+        batch.swap(set.ext_->pending);
+        set.insert_batch_(std::move(batch), execution::seq);
+    }
 
-        update(v);
-        update(temp);
+    void insert_one_(const T &value) {
+        if (index_() && index_find_(value)) {
+            return;
+        }
+        abandon_compaction_();
+        Node *inserted = nullptr;
+        descent_([&] { root_ = insert_(root_, probe(value), inserted); });
+        update_prev_and_next(inserted);
+        if (!inserted) {
+            return;
+        }
+        if (filter_()) {
+            filter_add_(inserted->value);
+            grow_filter_();
+        }
+        if (index_()) {
+            index_add_(inserted);
+        }
+    }
+
+    // Сортирует и вливает batch в дерево; буфер уже пуст.
+    template <typename ExecutionPolicy>
+    void insert_batch_(std::vector<T> batch, ExecutionPolicy &&policy) {
+        abandon_compaction_();
+        size_t workers = detail::worker_count(policy, batch.size());
+        if constexpr (!NodeTraits::is_always_equal::value) {
+            workers = 1;
+        }
+        auto less = [this](const T &a, const T &b) { return less_(a, b); };
+        detail::parallel_sort(batch.begin(), batch.end(), less, workers);
+        batch.erase(
+            std::unique(
+                batch.begin(), batch.end(),
+                [&less](const T &a, const T &b) { return !less(a, b); }
+            ),
+            batch.end()
+        );
+        if (root_) {
+            std::vector<Node *> found(batch.size());
+            detail::parallel_for(
+                batch.size(), workers,
+                [&](size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        found[i] = find_(root_, probe(batch[i]));
+                    }
+                }
+            );
+            size_t n = 0;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (found[i] && found[i]->dead) {
+                    revive_(found[i]);
+                }
+                if (!found[i]) {
+                    // Самоприсваивание перемещением опустошило бы строку.
+                    if (n != i) {
+                        batch[n] = std::move(batch[i]);
+                    }
+                    ++n;
+                }
+            }
+            // resize(n) требовал бы конструктор T по умолчанию.
+            batch.erase(batch.begin() + n, batch.end());
+        }
+        if (batch.empty()) {
+            return;
+        }
+        if constexpr (!Balance::height_ranked) {
+            // Слияние через split/join опирается на высоты, с другой
+            // политикой новые ключи вставляются по одному.
+            if (root_) {
+                for (const T &value : batch) {
+                    insert_one_(value);
+                }
+                return;
+            }
+        }
+
+        std::vector<Node *> nodes(batch.size(), nullptr);
+        Node *tree = nullptr;
+        try {
+            tree = build_(batch, nodes, 0, batch.size(), workers);
+        } catch (...) {
+            for (Node *v : nodes) {
+                if (v) {
+                    NodeTraits::destroy(allocator_, v);
+                    deallocate_node_(allocator_, v);
+                }
+            }
+            throw;
+        }
+        tree->parent = nullptr;
+
+        if (!root_) {
+            for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+                nodes[i]->next = nodes[i + 1];
+                nodes[i + 1]->prev = nodes[i];
+            }
+            root_ = tree;
+        } else {
+            root_ = union_(root_, tree, workers);
+            root_->parent = nullptr;
+            for (Node *v : nodes) {
+                update_prev_and_next(v);
+            }
+        }
+        if (filter_()) {
+            for (Node *v : nodes) {
+                filter_add_(v->value);
+            }
+            grow_filter_();
+        }
+        if (index_()) {
+            for (Node *v : nodes) {
+                index_add_(v);
+            }
+        }
+    }
+
+    Node *lookup_(const T &value) const {
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            if (index_()) {
+                return index_find_(value);
+            }
+            HotKeyCache<Node> *cache = cache_();
+            const CountingBloomFilter *filter = filter_();
+            if (cache || filter) {
+                std::uint64_t hash = hash_(value);
+                auto equal = [&](const Node *v) {
+                    return compare_(value, v->value) == 0;
+                };
+                if (Node *v = cache ? cache->find(hash, equal) : nullptr) {
+                    return v;
+                }
+                if (filter && !filter->may_contain(hash)) {
+                    return nullptr;
+                }
+                Node *v = find_live_(probe(value));
+                if (v && cache) {
+                    cache->put(hash, v);
+                }
+                return v;
+            }
+        }
+        return find_live_(probe(value));
+    }
+
+    Node *find_live_(const Probe &key) const {
+        Node *v = find_(root_, key);
+        return v && !v->dead ? v : nullptr;
+    }
+
+    // Ставит надгробие на живой узел v; из хеш-индекса v уже убран.
+    void bury_(Node *v) {
+        v->dead = true;
+        Extension &ext = *ext_;
+        ++ext.tombstones;
+        for (Node *u = v; u; u = u->parent) {
+            --u->size;
+        }
+        if (filter_()) {
+            filter_remove_(v->value);
+        }
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            if (HotKeyCache<Node> *cache = cache_()) {
+                cache->forget(hash_(v->value), v);
+            }
+        }
+        if (ext.tombstones >
+            ext.max_dead * (get_size(root_) + ext.tombstones)) {
+            purge();
+        }
+    }
+
+    void revive_(Node *v) {
+        v->dead = false;
+        --ext_->tombstones;
+        for (Node *u = v; u; u = u->parent) {
+            ++u->size;
+        }
+        if (filter_()) {
+            filter_add_(v->value);
+        }
+        if (index_()) {
+            index_add_(v);
+        }
+    }
+
+    void filter_add_(const T &value) {
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            filter_()->add(hash_(value));
+        }
+    }
+
+    void filter_remove_(const T &value) {
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            filter_()->remove(hash_(value));
+        }
+    }
+
+    Node *index_find_(const T &value) const {
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            return index_()->find(hash_(value), [&](const Node *v) {
+                return compare_(value, v->value) == 0;
+            });
+        }
+        return nullptr;
+    }
+
+    void index_add_(Node *v) {
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            index_()->insert(hash_(v->value), v);
+        }
+    }
+
+    void index_erase_(Node *v) {
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            index_()->erase(hash_(v->value), v);
+        }
+    }
+
+    void grow_filter_() {
+        size_t n = get_size(root_);
+        const CountingBloomFilter *filter = filter_();
+        if (n > filter->capacity()) {
+            rebuild_filter_(2 * n, filter->fp_rate());
+        }
+    }
+
+    void rebuild_filter_(size_t capacity, double fp_rate) {
+        auto filter = std::make_unique<CountingBloomFilter>(capacity, fp_rate);
+        extension_().filter.swap(filter);
+        for (const T &value : *this) {
+            filter_add_(value);
+        }
+    }
+
+    // Узел из блока compact() освобождается вместе со всем блоком, когда
+    // в нём не остаётся живых узлов.
+    void release_node_(Node *v) {
+        NodeTraits::destroy(allocator_, v);
+        if (ext_ && !ext_->slabs.empty()) {
+            auto slab = find_slab_(v);
+            if (slab != ext_->slabs.end()) {
+                if (--slab->live == 0 && slab->begin != ext_->compact_slab) {
+                    free_slab_(slab);
+                }
+                return;
+            }
+        }
+        deallocate_node_(allocator_, v);
+    }
+
+    // Блок узлов, выделенный одним вызовом allocate(capacity).
+    struct Slab {
+        Node *begin;
+        size_t capacity;
+        size_t live;
+    };
+
+    // Состояние редко включаемых режимов. Выделяется при первом включении,
+    // чтобы не раздувать каждое множество.
+    struct Extension {
+        // Блоки compact(), упорядоченные по адресу.
+        std::vector<Slab> slabs;
+        // Незавершённое уплотнение: следующий переносимый узел и куда его
+        // класть — блок или заранее выделенные по одной ячейки.
+        Node *compact_next = nullptr;
+        Node *compact_slab = nullptr;
+        std::vector<Node *> compact_cells;
+        size_t compact_filled = 0;
+        // Фильтр Блума перед деревом (enable_filter).
+        std::unique_ptr<CountingBloomFilter> filter;
+        // Хеш-индекс ключ -> узел (enable_hash_index).
+        std::unique_ptr<HashIndex<Node>> index;
+        // Кеш горячих ключей (enable_hot_cache).
+        std::unique_ptr<HotKeyCache<Node>> cache;
+        // Ленивое удаление: число надгробий и их допустимая доля;
+        // max_dead == 0 — выключено.
+        size_t tombstones = 0;
+        double max_dead = 0;
+        // Буферная вставка: ещё не влитые ключи; max_pending == 0 —
+        // выключена.
+        std::vector<T> pending;
+        size_t max_pending = 0;
+        void (*flusher)(AvlSet &) = nullptr;
+    };
+
+    CountingBloomFilter *filter_() const noexcept {
+        return ext_ ? ext_->filter.get() : nullptr;
+    }
+
+    HashIndex<Node> *index_() const noexcept {
+        return ext_ ? ext_->index.get() : nullptr;
+    }
+
+    HotKeyCache<Node> *cache_() const noexcept {
+        return ext_ ? ext_->cache.get() : nullptr;
+    }
+
+    Extension &extension_() {
+        if (!ext_) {
+            ext_ = std::make_unique<Extension>();
+        }
+        return *ext_;
+    }
+
+    static bool slab_before_(const Node *v, const Slab &slab) noexcept {
+        return std::less<const Node *>()(v, slab.begin);
+    }
+
+    typename std::vector<Slab>::iterator find_slab_(const Node *v) {
+        std::vector<Slab> &slabs = ext_->slabs;
+        auto it = std::upper_bound(slabs.begin(), slabs.end(), v, slab_before_);
+        if (it == slabs.begin()) {
+            return slabs.end();
+        }
+        --it;
+        return std::less<const Node *>()(v, it->begin + it->capacity)
+                   ? it
+                   : slabs.end();
+    }
+
+    void free_slab_(typename std::vector<Slab>::iterator slab) noexcept {
+        NodeTraits::deallocate(allocator_, slab->begin, slab->capacity);
+        stats_.on_deallocate();
+        ext_->slabs.erase(slab);
+    }
+
+    void start_compaction_(size_t n) {
+        Extension &ext = extension_();
+        if constexpr (detail::allocates_single_v<NodeAllocator>) {
+            ext.compact_cells.reserve(n);
+            try {
+                while (ext.compact_cells.size() < n) {
+                    ext.compact_cells.push_back(allocate_node_(allocator_));
+                }
+            } catch (...) {
+                for (Node *cell : ext.compact_cells) {
+                    deallocate_node_(allocator_, cell);
+                }
+                std::vector<Node *>().swap(ext.compact_cells);
+                throw;
+            }
+        } else {
+            Node *slab = NodeTraits::allocate(allocator_, n);
+            stats_.on_allocate();
+            auto it = std::upper_bound(
+                ext.slabs.begin(), ext.slabs.end(), slab, slab_before_
+            );
+            try {
+                ext.slabs.insert(it, Slab{slab, n, 0});
+            } catch (...) {
+                NodeTraits::deallocate(allocator_, slab, n);
+                stats_.on_deallocate();
+                throw;
+            }
+            ext.compact_slab = slab;
+        }
+        ext.compact_filled = 0;
+        ext.compact_next = begin().node_;
+    }
+
+    // Ячейка для следующего переносимого узла.
+    Node *compact_cell_() const noexcept {
+        if constexpr (detail::allocates_single_v<NodeAllocator>) {
+            return ext_->compact_cells[ext_->compact_filled];
+        } else {
+            return ext_->compact_slab + ext_->compact_filled;
+        }
+    }
+
+    void abandon_compaction_() noexcept {
+        if (!ext_ || !ext_->compact_next) {
+            return;
+        }
+        Extension &ext = *ext_;
+        ext.compact_next = nullptr;
+        if constexpr (detail::allocates_single_v<NodeAllocator>) {
+            for (size_t i = ext.compact_filled; i < ext.compact_cells.size();
+                 ++i) {
+                deallocate_node_(allocator_, ext.compact_cells[i]);
+            }
+            std::vector<Node *>().swap(ext.compact_cells);
+        } else {
+            auto slab = find_slab_(ext.compact_slab);
+            ext.compact_slab = nullptr;
+            if (slab->live == 0) {
+                free_slab_(slab);
+            }
+        }
+    }
+
+    // Переносит значение v в свободную ячейку slot и перевешивает на неё
+    // все ссылки соседей. Пока старый узел могут читать под EpochGuard,
+    // значение в нём должно остаться целым, поэтому с доменом — копия.
+    void relocate_(Node *v, Node *slot) {
+        if constexpr (std::is_copy_constructible_v<T>) {
+            if (domain_) {
+                NodeTraits::construct(
+                    allocator_, slot, std::as_const(v->value)
+                );
+            } else {
+                NodeTraits::construct(allocator_, slot, std::move(v->value));
+            }
+        } else {
+            NodeTraits::construct(allocator_, slot, std::move(v->value));
+        }
+        slot->prefix = v->prefix;
+        slot->dead = v->dead;
+        slot->hight = v->hight;
+        slot->size = v->size;
+        slot->parent = v->parent;
+        slot->left = v->left;
+        slot->right = v->right;
+        slot->next = v->next;
+        slot->prev = v->prev;
+        if (Node *parent = v->parent) {
+            (parent->left == v ? parent->left : parent->right) = slot;
+        } else {
+            root_ = slot;
+        }
+        if (slot->left) {
+            slot->left->parent = slot;
+        }
+        if (slot->right) {
+            slot->right->parent = slot;
+        }
+        if (slot->next) {
+            slot->next->prev = slot;
+        }
+        if (slot->prev) {
+            slot->prev->next = slot;
+        }
+        if constexpr (detail::is_hash_consistent_v<Compare, T>) {
+            if (HashIndex<Node> *index = index_()) {
+                index->replace(hash_(slot->value), v, slot);
+            }
+            if (HotKeyCache<Node> *cache = cache_()) {
+                cache->replace(hash_(slot->value), v, slot);
+            }
+        }
+        free_node(v);
+    }
+
+    Node *allocate_node_(NodeAllocator &allocator) {
+        Node *v = NodeTraits::allocate(allocator, 1);
+        stats_.on_allocate();
+        return v;
+    }
+
+    void deallocate_node_(NodeAllocator &allocator, Node *v) noexcept {
+        NodeTraits::deallocate(allocator, v, 1);
+        stats_.on_deallocate();
+    }
+
+    // Глубина спуска insert/erase равна числу сравнений ключа с узлами:
+    // на каждом уровне рекурсии ровно одно. Изменяющие операции
+    // однопоточные, так что разность счётчика относится только к ним.
+    template <typename F>
+    void descent_(F f) {
+        if constexpr (Stats::enabled) {
+            uint64_t before = stats_.comparisons();
+            f();
+            stats_.on_descent(stats_.comparisons() - before);
+        } else {
+            f();
+        }
+    }
+
+    // Вырезает минимум поддерева v, возвращает новый корень поддерева.
+    Node *detach_min_(Node *v) {
+        if (!v->left) {
+            if (v->right) {
+                v->right->parent = v->parent;
+            }
+            return v->right;
+        }
+        v->left = detach_min_(v->left);
+        if (v->left) {
+            v->left->parent = v;
+        }
+        return rebalance(v);
+    }
+
+    size_t get_hight(Node *v) const noexcept {
+        return v ? v->hight : 0;
+    }
+
+    size_t get_size(Node *v) const noexcept {
+        return v ? v->size : 0;
+    }
+
+    void update_size_(Node *v) noexcept {
+        v->size = !v->dead + get_size(v->left) + get_size(v->right);
+    }
+
+    // Ранг по высоте годится для любой политики, если поддерево
+    // сбалансировано по AVL: так строятся деревья из готовых узлов.
+    void update(Node *v) noexcept {
+        update_size_(v);
+        v->hight = 1 + std::max(get_hight(v->left), get_hight(v->right));
+    }
+
+    Node *right_rotate(Node *v) noexcept {
+        stats_.on_rotation();
+        Node *temp = v->left;
+        v->left = temp->right;
+        if (v->left) {
+            v->left->parent = v;
+        }
+        temp->right = v;
+
+        temp->parent = v->parent;
+        v->parent = temp;
+
+        update_size_(v);
+        update_size_(temp);
         return temp;
     }
 
     Node *left_rotate(Node *v) noexcept {
+        stats_.on_rotation();
         Node *temp = v->right;
         v->right = temp->left;
         if (v->right) {
@@ -370,65 +1740,226 @@ private:
         temp->parent = v->parent;
         v->parent = temp;
 
-        update(v);
-        update(temp);
+        update_size_(v);
+        update_size_(temp);
         return temp;
     }
 
-    int get_balance(Node *v) const noexcept {
-        if (!v) {
-            return 0;
+    // Повороты и счётчик перебалансировок для политики Balance; ранги
+    // политика правит сама.
+    struct BalanceOps {
+        AvlSet *set;
+
+        Node *rotate_left(Node *v) const noexcept {
+            return set->left_rotate(v);
         }
-        return get_hight(v->left) - get_hight(v->right);
-    }
+
+        Node *rotate_right(Node *v) const noexcept {
+            return set->right_rotate(v);
+        }
+
+        void on_rebalance() const noexcept {
+            set->stats_.on_rebalance();
+        }
+    };
 
     Node *rebalance(Node *v) {
         if (!v) {
             return v;
         }
-        update(v);
-        int b = get_balance(v);
-        if (b == 2) {
-            if (get_balance(v->left) >= 0) {
-                v = right_rotate(v);
-            } else {
-                v->left = left_rotate(v->left);
-                v = right_rotate(v);
-            }
-        } else if (b == -2) {
-            if (get_balance(v->right) <= 0) {
-                v = left_rotate(v);
-            } else {
-                v->right = right_rotate(v->right);
-                v = left_rotate(v);
-            }
-        }
-        return v;
+        update_size_(v);
+        return Balance::rebalance(v, BalanceOps{this});
     }
 
-    Node *insert_(Node *v, const T &value) {
+    Node *insert_(Node *v, const Probe &key, Node *&inserted) {
         if (!v) {
-            Node *node = NodeTraits::allocate(allocator_, 1);
-            NodeTraits::construct(allocator_, node, value);
-            update_prev_and_next(node);
+            Node *node = allocate_node_(allocator_);
+            NodeTraits::construct(allocator_, node, key.value);
+            inserted = node;
             return node;
         }
-        if (comp_(v->value, value)) {
-            v->right = insert_(v->right, value);
+        int c = compare_(key, v);
+        if (c > 0) {
+            v->right = insert_(v->right, key, inserted);
             if (v->right) {
                 v->right->parent = v;
             }
-        } else if (comp_(value, v->value)) {
-            v->left = insert_(v->left, value);
+        } else if (c < 0) {
+            v->left = insert_(v->left, key, inserted);
             if (v->left) {
                 v->left->parent = v;
             }
         } else {
+            if (v->dead) {
+                // Ключ под надгробием: узел оживает, размеры на пути к
+                // корню пересчитают вызывающие.
+                v->dead = false;
+                --ext_->tombstones;
+                update_size_(v);
+                inserted = v;
+            }
             return v;
         }
         return rebalance(v);
     }
 
+    // Строит идеально сбалансированное поддерево из отсортированных
+    // batch[lo, hi), половины диапазона уходят в разные потоки.
+    Node *build_(
+        const std::vector<T> &batch,
+        std::vector<Node *> &nodes,
+        size_t lo,
+        size_t hi,
+        size_t workers
+    ) {
+        if (lo == hi) {
+            return nullptr;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        NodeAllocator allocator(allocator_);
+        Node *v = allocate_node_(allocator);
+        try {
+            NodeTraits::construct(allocator, v, batch[mid]);
+        } catch (...) {
+            deallocate_node_(allocator, v);
+            throw;
+        }
+        nodes[mid] = v;
+        detail::fork_join(
+            workers > 1,
+            [&] { v->left = build_(batch, nodes, lo, mid, workers / 2); },
+            [&] {
+                v->right =
+                    build_(batch, nodes, mid + 1, hi, workers - workers / 2);
+            }
+        );
+        if (v->left) {
+            v->left->parent = v;
+        }
+        if (v->right) {
+            v->right->parent = v;
+        }
+        update(v);
+        return v;
+    }
+
+    // Собирает из узлов nodes[lo, hi) идеально сбалансированное поддерево.
+    Node *relink_(const std::vector<Node *> &nodes, size_t lo, size_t hi) {
+        if (lo == hi) {
+            return nullptr;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        Node *v = nodes[mid];
+        v->left = relink_(nodes, lo, mid);
+        v->right = relink_(nodes, mid + 1, hi);
+        if (v->left) {
+            v->left->parent = v;
+        }
+        if (v->right) {
+            v->right->parent = v;
+        }
+        update(v);
+        return v;
+    }
+
+    // Читает n ключей по порядку и строит из них сбалансированное поддерево;
+    // last — последний созданный узел, по нему идёт цепочка next/prev.
+    template <typename Codec>
+    Node *read_tree_(
+        std::istream &in,
+        const Codec &codec,
+        size_t n,
+        Node *&last
+    ) {
+        if (n == 0) {
+            return nullptr;
+        }
+        Node *left = read_tree_(in, codec, n / 2, last);
+        T value = codec.decode(in, last ? &last->value : nullptr);
+        if (last && !less_(last->value, value)) {
+            throw std::runtime_error("AvlSet::deserialize: keys out of order");
+        }
+        Node *v = allocate_node_(allocator_);
+        try {
+            NodeTraits::construct(allocator_, v, std::move(value));
+        } catch (...) {
+            deallocate_node_(allocator_, v);
+            throw;
+        }
+        v->prev = last;
+        if (last) {
+            last->next = v;
+        }
+        last = v;
+        Node *right = read_tree_(in, codec, n - n / 2 - 1, last);
+        return attach(left, v, right);
+    }
+
+    Node *attach(Node *left, Node *v, Node *right) noexcept {
+        v->left = left;
+        v->right = right;
+        if (left) {
+            left->parent = v;
+        }
+        if (right) {
+            right->parent = v;
+        }
+        update(v);
+        return v;
+    }
+
+    // Соединяет left < v < right в одно AVL-дерево за O(|h(left) - h(right)|).
+    Node *join_(Node *left, Node *v, Node *right) {
+        if (get_hight(left) > get_hight(right) + 1) {
+            Node *c = join_(left->right, v, right);
+            left->right = c;
+            c->parent = left;
+            return rebalance(left);
+        }
+        if (get_hight(right) > get_hight(left) + 1) {
+            Node *c = join_(left, v, right->left);
+            right->left = c;
+            c->parent = right;
+            return rebalance(right);
+        }
+        return attach(left, v, right);
+    }
+
+    // Делит дерево на ключи меньше key и больше key (key в дереве нет).
+    std::pair<Node *, Node *> split_(Node *v, const Probe &key) {
+        if (!v) {
+            return {nullptr, nullptr};
+        }
+        Node *left = v->left;
+        Node *right = v->right;
+        if (less_(key, v)) {
+            auto [l, r] = split_(left, key);
+            return {l, join_(r, v, right)};
+        }
+        auto [l, r] = split_(right, key);
+        return {join_(left, v, l), r};
+    }
+
+    // Объединение двух деревьев с непересекающимися ключами.
+    Node *union_(Node *a, Node *b, size_t workers) {
+        if (!a) {
+            return b;
+        }
+        if (!b) {
+            return a;
+        }
+        auto [l, r] = split_(a, probe(b->value));
+        Node *left = nullptr;
+        Node *right = nullptr;
+        Node *bl = b->left;
+        Node *br = b->right;
+        detail::fork_join(
+            workers > 1, [&] { left = union_(l, bl, workers / 2); },
+            [&] { right = union_(r, br, workers - workers / 2); }
+        );
+        return join_(left, b, right);
+    }
+
     void update_prev_and_next(Node *v) {
         if (!v) {
             return;
@@ -445,30 +1976,108 @@ private:
         }
     }
 
-    Node *find_(Node *v, const T &value) const {
-        if (!v) {
-            return nullptr;
+    Node *last_() const {
+        sync_();
+        Node *v = root_;
+        while (v && v->right) {
+            v = v->right;
+        }
+        return live_back_(v);
+    }
+
+    // Первый живой узел начиная с v по next (по prev для live_back_).
+    static Node *live_(Node *v) noexcept {
+        while (v && v->dead) {
+            v = v->next;
+        }
+        return v;
+    }
+
+    static Node *live_back_(Node *v) noexcept {
+        while (v && v->dead) {
+            v = v->prev;
         }
-        if (comp_(value, v->value)) {
-            return find_(v->left, value);
-        } else if (comp_(v->value, value)) {
-            return find_(v->right, value);
+        return v;
+    }
+
+    // Первый узел не меньше key, поиск от узла hint.
+    Node *finger_(Node *v, const Probe &key) const {
+        Node *res = nullptr;
+        size_t depth = 1;
+        if (!v) {
+            v = root_;
+            depth = 0;
+        } else if (less_(v, key)) {
+            // Ответ правее. Чаще всего это соседний узел.
+            Node *next = v->next;
+            if (!next || !less_(next, key)) {
+                stats_.on_descent(2);
+                return live_(next);
+            }
+            // Поднимаемся до предка, у которого v в левом поддереве и
+            // который сам не меньше key: ответ — он или в этом поддереве.
+            for (Node *p = v->parent; p; p = v->parent, ++depth) {
+                if (v == p->left && !less_(p, key)) {
+                    res = p;
+                    break;
+                }
+                v = p;
+            }
         } else {
-            return v;
+            // Ответ — hint или левее.
+            Node *prev = v->prev;
+            if (!prev || less_(prev, key)) {
+                stats_.on_descent(2);
+                return live_(v);
+            }
+            // Поднимаемся до предка меньше key, у которого v в правом
+            // поддереве: ответ — в этом поддереве, hint в нём есть.
+            for (Node *p = v->parent; p; p = v->parent, ++depth) {
+                if (v == p->right && less_(p, key)) {
+                    break;
+                }
+                v = p;
+            }
+        }
+        for (; v; ++depth) {
+            if (!less_(v, key)) {
+                res = v;
+                v = v->left;
+            } else {
+                v = v->right;
+            }
         }
+        stats_.on_descent(depth);
+        return live_(res);
     }
 
-    Node *erase_(Node *v, const T &x) {
+    // Узел с ключом key, в том числе надгробие.
+    Node *find_(Node *v, const Probe &key) const {
+        size_t depth = 0;
+        for (; v; ++depth) {
+            int c = compare_(key, v);
+            if (c == 0) {
+                stats_.on_descent(depth + 1);
+                return v;
+            }
+            v = c < 0 ? v->left : v->right;
+        }
+        stats_.on_descent(depth);
+        return nullptr;
+    }
+
+    Node *erase_(Node *v, const Probe &x) {
         if (!v) {
             return nullptr;
         }
 
-        if (comp_(x, v->value)) {
+        int c = compare_(x, v);
+        if (c < 0) {
             v->left = erase_(v->left, x);
             if (v->left) {
                 v->left->parent = v;
             }
-        } else if (comp_(v->value, x)) {
+        } else if (c > 0) {
             v->right = erase_(v->right, x);
             if (v->right) {
                 v->right->parent = v;
@@ -488,29 +2097,29 @@ private:
                 if (child) {
                     child->parent = v->parent;
                 }
-                NodeTraits::destroy(allocator_, v);
-                NodeTraits::deallocate(allocator_, v, 1);
+                free_node(v);
                 return child;
             } else {
-                // У узла два ребёнка — ищем next (минимум в правом поддереве)
-                Node *succ = v->right;
-                while (succ->left) {
-                    succ = succ->left;
-                }
+                // У узла два ребёнка — на его место встаёт сам узел next
+                // (минимум в правом поддереве), значения не копируются.
+                Node *succ = v->next;
+                Node *right = detach_min_(v->right);
 
-                // Обновим prev/next перед заменой
-                if (succ->prev) {
-                    succ->prev->next = succ->next;
-                }
-                if (succ->next) {
-                    succ->next->prev = succ->prev;
+                succ->prev = v->prev;
+                if (v->prev) {
+                    v->prev->next = succ;
                 }
 
-                v->value = succ->value;  // копируем значение
-                v->right = erase_(v->right, succ->value);
-                if (v->right) {
-                    v->right->parent = v;
+                succ->parent = v->parent;
+                succ->hight = v->hight;
+                succ->left = v->left;
+                succ->left->parent = succ;
+                succ->right = right;
+                if (right) {
+                    right->parent = succ;
                 }
+                free_node(v);
+                v = succ;
             }
         }
 
@@ -527,9 +2136,12 @@ private:
         print_(v->right);
     }
 
-    Node *root_ = nullptr;
+    NodePtr root_ = nullptr;
     Compare comp_;
     NodeAllocator allocator_;
+    EpochDomain *domain_ = nullptr;
+    [[no_unique_address]] mutable Stats stats_;
+    std::unique_ptr<Extension> ext_;
 };
 
 }  // namespace my_algorithms
\ No newline at end of file
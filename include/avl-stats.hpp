@@ -0,0 +1,199 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace my_algorithms {
+
+// Политика статистики AvlSet по умолчанию: все хуки пустые, объект пустой
+// и благодаря [[no_unique_address]] не занимает места в множестве.
+// Политика с enabled = true должна ещё отдавать comparisons() — по нему
+// считается глубина спуска insert/erase.
+struct NullStats {
+    static constexpr bool enabled = false;
+
+    void on_compare() const noexcept {
+    }
+
+    void on_rotation() const noexcept {
+    }
+
+    void on_rebalance() const noexcept {
+    }
+
+    void on_allocate() const noexcept {
+    }
+
+    void on_deallocate() const noexcept {
+    }
+
+    void on_descent(size_t) const noexcept {
+    }
+};
+
+// Счётчики сравнений ключа с узлом, поворотов, перебалансировок (узлов,
+// где политике балансировки понадобились повороты), выделений и
+// освобождений узлов и гистограмма глубины спуска в
+// find/insert/erase/lower_bound/upper_bound.
+// Счётчики атомарные (relaxed): константные методы множества можно звать
+// из нескольких потоков.
+class CountingStats {
+public:
+    static constexpr bool enabled = true;
+    static constexpr size_t depth_buckets = 64;
+
+    void on_compare() noexcept {
+        bump(comparisons_);
+    }
+
+    void on_rotation() noexcept {
+        bump(rotations_);
+    }
+
+    void on_rebalance() noexcept {
+        bump(rebalances_);
+    }
+
+    void on_allocate() noexcept {
+        bump(allocations_);
+    }
+
+    void on_deallocate() noexcept {
+        bump(deallocations_);
+    }
+
+    void on_descent(size_t depth) noexcept {
+        bump(depth_[depth < depth_buckets ? depth : depth_buckets - 1]);
+        depth_sum_.fetch_add(depth, std::memory_order_relaxed);
+    }
+
+    uint64_t comparisons() const noexcept {
+        return load(comparisons_);
+    }
+
+    uint64_t rotations() const noexcept {
+        return load(rotations_);
+    }
+
+    uint64_t rebalances() const noexcept {
+        return load(rebalances_);
+    }
+
+    uint64_t allocations() const noexcept {
+        return load(allocations_);
+    }
+
+    uint64_t deallocations() const noexcept {
+        return load(deallocations_);
+    }
+
+    // Число спусков глубины depth (последняя корзина — depth и больше).
+    uint64_t descents(size_t depth) const noexcept {
+        return depth < depth_buckets ? load(depth_[depth]) : 0;
+    }
+
+    uint64_t descents() const noexcept {
+        uint64_t res = 0;
+        for (const auto &bucket : depth_) {
+            res += load(bucket);
+        }
+        return res;
+    }
+
+    uint64_t depth_sum() const noexcept {
+        return load(depth_sum_);
+    }
+
+    void reset() noexcept {
+        for (auto *counter :
+             {&comparisons_, &rotations_, &rebalances_, &allocations_,
+              &deallocations_, &depth_sum_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+        for (auto &bucket : depth_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Текстовый формат Prometheus; гистограмма глубины — накопительная,
+    // корзины до наибольшей встреченной глубины.
+    std::string to_prometheus(std::string_view prefix = "avlset") const {
+        std::string res;
+        auto counter = [&](std::string_view name, uint64_t value) {
+            std::string metric = std::string(prefix) + "_" + std::string(name);
+            res += "# TYPE " + metric + " counter\n";
+            res += metric + " " + std::to_string(value) + "\n";
+        };
+        counter("comparisons_total", comparisons());
+        counter("rotations_total", rotations());
+        counter("rebalances_total", rebalances());
+        counter("allocations_total", allocations());
+        counter("deallocations_total", deallocations());
+
+        std::string metric = std::string(prefix) + "_descent_depth";
+        res += "# TYPE " + metric + " histogram\n";
+        size_t top = last_bucket();
+        uint64_t total = 0;
+        for (size_t d = 0; d <= top && d + 1 < depth_buckets; ++d) {
+            total += descents(d);
+            res += metric + "_bucket{le=\"" + std::to_string(d) + "\"} " +
+                   std::to_string(total) + "\n";
+        }
+        total = descents();
+        res += metric + "_bucket{le=\"+Inf\"} " + std::to_string(total) + "\n";
+        res += metric + "_sum " + std::to_string(depth_sum()) + "\n";
+        res += metric + "_count " + std::to_string(total) + "\n";
+        return res;
+    }
+
+    std::string to_json() const {
+        std::string res = "{";
+        res += "\"comparisons\":" + std::to_string(comparisons());
+        res += ",\"rotations\":" + std::to_string(rotations());
+        res += ",\"rebalances\":" + std::to_string(rebalances());
+        res += ",\"allocations\":" + std::to_string(allocations());
+        res += ",\"deallocations\":" + std::to_string(deallocations());
+        res += ",\"descent_depth\":{\"count\":" + std::to_string(descents());
+        res += ",\"sum\":" + std::to_string(depth_sum());
+        res += ",\"histogram\":[";
+        size_t top = last_bucket();
+        for (size_t d = 0; d <= top; ++d) {
+            res += (d ? "," : "") + std::to_string(descents(d));
+        }
+        res += "]}}";
+        return res;
+    }
+
+private:
+    static void bump(std::atomic<uint64_t> &counter) noexcept {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static uint64_t load(const std::atomic<uint64_t> &counter) noexcept {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    size_t last_bucket() const noexcept {
+        size_t top = 0;
+        for (size_t d = 0; d < depth_buckets; ++d) {
+            if (load(depth_[d])) {
+                top = d;
+            }
+        }
+        return top;
+    }
+
+    std::atomic<uint64_t> comparisons_ = 0;
+    std::atomic<uint64_t> rotations_ = 0;
+    std::atomic<uint64_t> rebalances_ = 0;
+    std::atomic<uint64_t> allocations_ = 0;
+    std::atomic<uint64_t> deallocations_ = 0;
+    std::atomic<uint64_t> depth_sum_ = 0;
+    std::array<std::atomic<uint64_t>, depth_buckets> depth_{};
+};
+
+}  // namespace my_algorithms
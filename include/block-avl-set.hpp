@@ -0,0 +1,591 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include "simd-search.hpp"
+
+namespace my_algorithms {
+
+template <typename T>
+inline constexpr std::size_t default_block_capacity =
+    std::max<std::size_t>(8, 256 / sizeof(T));
+
+// AVL-дерево, в каждом узле которого лежит отсортированный блок до B ключей.
+template <
+    typename T,
+    std::size_t B = default_block_capacity<T>,
+    typename Compare = std::less<T>,
+    typename Allocator = std::allocator<T>>
+class BlockAvlSet {
+    static_assert(B >= 4, "block must hold at least 4 keys");
+
+    struct Node {
+        alignas(T) unsigned char storage[B * sizeof(T)];
+        size_t count;
+        size_t hight;
+        size_t size;
+        Node *parent;
+        Node *left;
+        Node *right;
+        Node *next;
+        Node *prev;
+
+        Node() noexcept
+            : count(0),
+              hight(1),
+              size(0),
+              parent(nullptr),
+              left(nullptr),
+              right(nullptr),
+              next(nullptr),
+              prev(nullptr) {
+        }
+
+        T *keys() noexcept {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+
+        const T *keys() const noexcept {
+            return std::launder(reinterpret_cast<const T *>(storage));
+        }
+
+        T &front() noexcept {
+            return keys()[0];
+        }
+
+        T &back() noexcept {
+            return keys()[count - 1];
+        }
+    };
+
+    struct iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        iterator() : set_(nullptr), node_(nullptr), pos_(0) {
+        }
+
+        iterator(const BlockAvlSet *set, Node *node, size_t pos)
+            : set_(set), node_(node), pos_(pos) {
+        }
+
+        reference operator*() const noexcept {
+            return node_->keys()[pos_];
+        }
+
+        pointer operator->() const noexcept {
+            return node_->keys() + pos_;
+        }
+
+        iterator &operator++() {
+            if (++pos_ == node_->count) {
+                node_ = node_->next;
+                pos_ = 0;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        iterator &operator--() {
+            if (!node_) {
+                node_ = set_->last_node();
+                pos_ = node_->count - 1;
+            } else if (pos_ == 0) {
+                node_ = node_->prev;
+                pos_ = node_->count - 1;
+            } else {
+                --pos_;
+            }
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator tmp = *this;
+            --(*this);
+            return tmp;
+        }
+
+        bool operator==(const iterator &other) const {
+            return node_ == other.node_ && pos_ == other.pos_;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+    private:
+        const BlockAvlSet *set_;
+        Node *node_;
+        size_t pos_;
+        friend class BlockAvlSet;
+    };
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+
+    using iterator = typename BlockAvlSet::iterator;
+    using const_iterator = typename BlockAvlSet::iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using NodeAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+    static constexpr size_t block_capacity = B;
+
+    BlockAvlSet() {
+    }
+
+    BlockAvlSet(const BlockAvlSet &) = delete;
+    BlockAvlSet &operator=(const BlockAvlSet &) = delete;
+
+    ~BlockAvlSet() {
+        destroy(root_);
+    }
+
+    iterator begin() const {
+        Node *v = root_;
+        if (!v) {
+            return end();
+        }
+        while (v->left) {
+            v = v->left;
+        }
+        return iterator(this, v, 0);
+    }
+
+    iterator end() const {
+        return iterator(this, nullptr, 0);
+    }
+
+    reverse_iterator rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const {
+        return reverse_iterator(begin());
+    }
+
+    iterator find(const T &value) const {
+        Node *v = root_;
+        while (v) {
+            if (comp_(value, v->front())) {
+                v = v->left;
+            } else if (comp_(v->back(), value)) {
+                v = v->right;
+            } else {
+                size_t pos = block_lower_bound(v, value);
+                if (comp_(value, v->keys()[pos])) {
+                    return end();
+                }
+                return iterator(this, v, pos);
+            }
+        }
+        return end();
+    }
+
+    bool contains(const T &value) const {
+        return find(value) != end();
+    }
+
+    size_t count(const T &value) const {
+        return contains(value) ? 1 : 0;
+    }
+
+    iterator lower_bound(const T &value) const {
+        Node *res = nullptr;
+        Node *v = root_;
+        while (v) {
+            if (comp_(v->back(), value)) {
+                v = v->right;
+            } else if (!comp_(v->front(), value)) {
+                res = v;
+                v = v->left;
+            } else {
+                return iterator(this, v, block_lower_bound(v, value));
+            }
+        }
+        return iterator(this, res, 0);
+    }
+
+    iterator upper_bound(const T &value) const {
+        Node *res = nullptr;
+        Node *v = root_;
+        while (v) {
+            if (!comp_(value, v->back())) {
+                v = v->right;
+            } else if (comp_(value, v->front())) {
+                res = v;
+                v = v->left;
+            } else {
+                return iterator(this, v, block_upper_bound(v, value));
+            }
+        }
+        return iterator(this, res, 0);
+    }
+
+    std::pair<iterator, iterator> equal_range(const T &value) const {
+        return {lower_bound(value), upper_bound(value)};
+    }
+
+    void insert(const T &value) {
+        if (!root_) {
+            root_ = create_node();
+            construct_key(root_, 0, value);
+            update(root_);
+            return;
+        }
+        Node *v = root_;
+        while (true) {
+            if (v->left && comp_(value, v->front())) {
+                v = v->left;
+            } else if (v->right && comp_(v->back(), value)) {
+                v = v->right;
+            } else {
+                break;
+            }
+        }
+        size_t pos = block_lower_bound(v, value);
+        if (pos < v->count && !comp_(value, v->keys()[pos])) {
+            return;
+        }
+        if (v->count < B) {
+            insert_key(v, pos, value);
+            fix_upward(v);
+            return;
+        }
+        Node *w = split(v);
+        if (pos <= v->count) {
+            insert_key(v, pos, value);
+        } else {
+            insert_key(w, pos - v->count, value);
+        }
+        fix_upward(w);
+    }
+
+    void erase(const T &value) {
+        iterator it = find(value);
+        if (it == end()) {
+            return;
+        }
+        Node *v = it.node_;
+        erase_key(v, it.pos_);
+        if (v->count == 0) {
+            remove_node(v);
+            return;
+        }
+        if (v->count >= B / 4) {
+            fix_upward(v);
+            return;
+        }
+        // Блок опустел на три четверти — сливаем его с соседом.
+        if (v->next && v->count + v->next->count <= B) {
+            Node *w = v->next;
+            move_keys(w, v);
+            fix_upward(v);
+            remove_node(w);
+        } else if (v->prev && v->prev->count + v->count <= B) {
+            Node *w = v->prev;
+            move_keys(v, w);
+            fix_upward(w);
+            remove_node(v);
+        } else {
+            fix_upward(v);
+        }
+    }
+
+    size_t size() const noexcept {
+        return get_size(root_);
+    }
+
+    bool empty() const noexcept {
+        return root_ == nullptr;
+    }
+
+    void clear() {
+        destroy(root_);
+        root_ = nullptr;
+    }
+
+    void swap(BlockAvlSet &other) noexcept {
+        std::swap(root_, other.root_);
+        std::swap(comp_, other.comp_);
+        std::swap(allocator_, other.allocator_);
+    }
+
+    key_compare key_comp() const {
+        return comp_;
+    }
+
+    value_compare value_comp() const {
+        return comp_;
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_;
+    }
+
+    friend bool operator==(const BlockAvlSet &lhs, const BlockAvlSet &rhs) {
+        return lhs.size() == rhs.size() &&
+               std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    friend bool operator!=(const BlockAvlSet &lhs, const BlockAvlSet &rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    size_t block_lower_bound(const Node *v, const T &value) const {
+        if constexpr (simd::is_searchable_v<T, Compare>) {
+            return simd::lower_bound(v->keys(), v->count, value);
+        } else {
+            return std::lower_bound(
+                       v->keys(), v->keys() + v->count, value, comp_
+                   ) -
+                   v->keys();
+        }
+    }
+
+    size_t block_upper_bound(const Node *v, const T &value) const {
+        if constexpr (simd::is_searchable_v<T, Compare>) {
+            return simd::upper_bound(v->keys(), v->count, value);
+        } else {
+            return std::upper_bound(
+                       v->keys(), v->keys() + v->count, value, comp_
+                   ) -
+                   v->keys();
+        }
+    }
+
+    Node *last_node() const noexcept {
+        Node *v = root_;
+        while (v && v->right) {
+            v = v->right;
+        }
+        return v;
+    }
+
+    Node *create_node() {
+        Node *node = NodeTraits::allocate(allocator_, 1);
+        NodeTraits::construct(allocator_, node);
+        return node;
+    }
+
+    void delete_node(Node *v) {
+        std::destroy_n(v->keys(), v->count);
+        NodeTraits::destroy(allocator_, v);
+        NodeTraits::deallocate(allocator_, v, 1);
+    }
+
+    void destroy(Node *v) {
+        if (!v) {
+            return;
+        }
+        destroy(v->left);
+        destroy(v->right);
+        delete_node(v);
+    }
+
+    void construct_key(Node *v, size_t pos, const T &value) {
+        ::new (static_cast<void *>(v->keys() + pos)) T(value);
+        ++v->count;
+    }
+
+    void insert_key(Node *v, size_t pos, const T &value) {
+        T *keys = v->keys();
+        if (pos == v->count) {
+            construct_key(v, pos, value);
+            return;
+        }
+        ::new (static_cast<void *>(keys + v->count))
+            T(std::move(keys[v->count - 1]));
+        std::move_backward(keys + pos, keys + v->count - 1, keys + v->count);
+        keys[pos] = value;
+        ++v->count;
+    }
+
+    void erase_key(Node *v, size_t pos) {
+        T *keys = v->keys();
+        std::move(keys + pos + 1, keys + v->count, keys + pos);
+        std::destroy_at(keys + v->count - 1);
+        --v->count;
+    }
+
+    // Переносит все ключи from в конец блока to.
+    void move_keys(Node *from, Node *to) {
+        std::uninitialized_move_n(
+            from->keys(), from->count, to->keys() + to->count
+        );
+        std::destroy_n(from->keys(), from->count);
+        to->count += from->count;
+        from->count = 0;
+    }
+
+    // Делит полный блок пополам, верхняя половина уходит в новый узел,
+    // который становится следующим за v в порядке обхода.
+    Node *split(Node *v) {
+        Node *w = create_node();
+        size_t half = v->count / 2;
+        std::uninitialized_move_n(
+            v->keys() + half, v->count - half, w->keys()
+        );
+        std::destroy_n(v->keys() + half, v->count - half);
+        w->count = v->count - half;
+        v->count = half;
+
+        if (!v->right) {
+            v->right = w;
+            w->parent = v;
+        } else {
+            Node *u = v->right;
+            while (u->left) {
+                u = u->left;
+            }
+            u->left = w;
+            w->parent = u;
+        }
+        w->prev = v;
+        w->next = v->next;
+        if (v->next) {
+            v->next->prev = w;
+        }
+        v->next = w;
+        return w;
+    }
+
+    // Вырезает из дерева пустой узел v.
+    void remove_node(Node *v) {
+        if (v->left && v->right) {
+            Node *s = v->next;
+            move_keys(s, v);
+            v = s;
+        }
+        Node *child = v->left ? v->left : v->right;
+        Node *parent = v->parent;
+        if (child) {
+            child->parent = parent;
+        }
+        replace_child(parent, v, child);
+        if (v->prev) {
+            v->prev->next = v->next;
+        }
+        if (v->next) {
+            v->next->prev = v->prev;
+        }
+        delete_node(v);
+        fix_upward(parent);
+    }
+
+    void replace_child(Node *parent, Node *old_child, Node *new_child) {
+        if (!parent) {
+            root_ = new_child;
+        } else if (parent->left == old_child) {
+            parent->left = new_child;
+        } else {
+            parent->right = new_child;
+        }
+    }
+
+    void fix_upward(Node *v) {
+        while (v) {
+            Node *parent = v->parent;
+            Node *r = rebalance(v);
+            replace_child(parent, v, r);
+            v = parent;
+        }
+    }
+
+    size_t get_hight(Node *v) const noexcept {
+        return v ? v->hight : 0;
+    }
+
+    size_t get_size(Node *v) const noexcept {
+        return v ? v->size : 0;
+    }
+
+    void update(Node *v) noexcept {
+        v->size = v->count + get_size(v->left) + get_size(v->right);
+        v->hight = 1 + std::max(get_hight(v->left), get_hight(v->right));
+    }
+
+    Node *right_rotate(Node *v) noexcept {
+        Node *temp = v->left;
+        v->left = temp->right;
+        if (v->left) {
+            v->left->parent = v;
+        }
+        temp->right = v;
+        temp->parent = v->parent;
+        v->parent = temp;
+
+        update(v);
+        update(temp);
+        return temp;
+    }
+
+    Node *left_rotate(Node *v) noexcept {
+        Node *temp = v->right;
+        v->right = temp->left;
+        if (v->right) {
+            v->right->parent = v;
+        }
+        temp->left = v;
+        temp->parent = v->parent;
+        v->parent = temp;
+
+        update(v);
+        update(temp);
+        return temp;
+    }
+
+    int get_balance(Node *v) const noexcept {
+        if (!v) {
+            return 0;
+        }
+        return get_hight(v->left) - get_hight(v->right);
+    }
+
+    Node *rebalance(Node *v) {
+        update(v);
+        int b = get_balance(v);
+        if (b == 2) {
+            if (get_balance(v->left) < 0) {
+                v->left = left_rotate(v->left);
+            }
+            v = right_rotate(v);
+        } else if (b == -2) {
+            if (get_balance(v->right) > 0) {
+                v->right = right_rotate(v->right);
+            }
+            v = left_rotate(v);
+        }
+        return v;
+    }
+
+    Node *root_ = nullptr;
+    Compare comp_;
+    NodeAllocator allocator_;
+};
+
+}  // namespace my_algorithms
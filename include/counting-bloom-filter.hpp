@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace my_algorithms {
+
+// Блочный фильтр Блума со счётчиками: все k проб одного ключа попадают в
+// один блок размером с кеш-линию (128 четырёхбитных счётчиков), так что
+// проверка читает ровно одну линию. Счётчики позволяют удалять ключи;
+// насыщенный счётчик (15) больше не уменьшается — фильтр остаётся
+// корректным, лишь немного растёт доля ложных срабатываний.
+class CountingBloomFilter {
+    struct alignas(64) Block {
+        std::array<std::uint64_t, 8> words{};
+    };
+
+    static constexpr unsigned slots_per_block = 128;
+    static constexpr std::uint64_t counter_max = 15;
+
+public:
+    // capacity — на сколько ключей рассчитан фильтр, fp_rate — желаемая
+    // доля ложных срабатываний при таком числе ключей.
+    CountingBloomFilter(size_t capacity, double fp_rate)
+        : capacity_(std::max<size_t>(capacity, 1)), fp_rate_(fp_rate) {
+        if (!(fp_rate > 0 && fp_rate < 1)) {
+            throw std::invalid_argument("CountingBloomFilter: bad fp_rate");
+        }
+        double ln2 = std::log(2.0);
+        double slots_per_key = -std::log(fp_rate) / (ln2 * ln2);
+        hashes_ = static_cast<unsigned>(
+            std::clamp(std::lround(slots_per_key * ln2), long(1), long(16))
+        );
+        // Число ключей в блоке случайно, и перегруженные блоки портят долю
+        // ложных срабатываний; уменьшаем нагрузку на блок, пока оценка не
+        // станет не хуже заказанной.
+        double keys_per_block = slots_per_block / slots_per_key;
+        while (keys_per_block > 0.5 &&
+               blocked_fp_rate(keys_per_block, hashes_) > fp_rate) {
+            keys_per_block *= 0.95;
+        }
+        auto blocks = static_cast<size_t>(
+            std::ceil(static_cast<double>(capacity_) / keys_per_block)
+        );
+        blocks_.resize(std::max<size_t>(blocks, 1));
+    }
+
+    void add(std::uint64_t hash) noexcept {
+        for_each_slot(hash, [](std::uint64_t &word, unsigned shift) {
+            if (((word >> shift) & counter_max) != counter_max) {
+                word += std::uint64_t(1) << shift;
+            }
+        });
+    }
+
+    void remove(std::uint64_t hash) noexcept {
+        for_each_slot(hash, [](std::uint64_t &word, unsigned shift) {
+            std::uint64_t counter = (word >> shift) & counter_max;
+            if (counter != 0 && counter != counter_max) {
+                word -= std::uint64_t(1) << shift;
+            }
+        });
+    }
+
+    bool may_contain(std::uint64_t hash) const noexcept {
+        const Block &block = blocks_[block_of(hash)];
+        Probes probes(hash);
+        for (unsigned i = 0; i < hashes_; ++i) {
+            unsigned slot = probes.next();
+            if (((block.words[slot / 16] >> (slot % 16 * 4)) & counter_max) ==
+                0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void clear() noexcept {
+        std::fill(blocks_.begin(), blocks_.end(), Block());
+    }
+
+    size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    double fp_rate() const noexcept {
+        return fp_rate_;
+    }
+
+    size_t memory_bytes() const noexcept {
+        return blocks_.size() * sizeof(Block);
+    }
+
+    // Перемешивание splitmix64: std::hash для целых — тождество.
+    static std::uint64_t mix(std::uint64_t x) noexcept {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+private:
+    // Оценка доли ложных срабатываний: число ключей в блоке — пуассоновское
+    // со средним keys_per_block.
+    static double blocked_fp_rate(double keys_per_block, unsigned hashes) {
+        double res = 0;
+        double poisson = std::exp(-keys_per_block);
+        double empty = 1 - 1.0 / slots_per_block;
+        for (unsigned j = 0; j < 4 * slots_per_block; ++j) {
+            if (j > 0) {
+                poisson *= keys_per_block / j;
+            }
+            double set = 1 - std::pow(empty, double(hashes) * j);
+            res += poisson * std::pow(set, hashes);
+            if (j > keys_per_block && poisson < 1e-12) {
+                break;
+            }
+        }
+        return res;
+    }
+
+    size_t block_of(std::uint64_t hash) const noexcept {
+        return static_cast<size_t>(mulhi(hash, blocks_.size()));
+    }
+
+    // Старшие 64 бита произведения: переводит hash в [0, b) без деления.
+    static std::uint64_t mulhi(std::uint64_t a, std::uint64_t b) noexcept {
+#ifdef __SIZEOF_INT128__
+        __extension__ typedef unsigned __int128 uint128;
+        return static_cast<std::uint64_t>((uint128(a) * b) >> 64);
+#else
+        const std::uint64_t mask = 0xFFFFFFFF;
+        std::uint64_t lo_lo = (a & mask) * (b & mask);
+        std::uint64_t hi_lo = (a >> 32) * (b & mask);
+        std::uint64_t lo_hi = (a & mask) * (b >> 32);
+        std::uint64_t hi_hi = (a >> 32) * (b >> 32);
+        std::uint64_t cross = (lo_lo >> 32) + (hi_lo & mask) + lo_hi;
+        return hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+    }
+
+    // Номера счётчиков в блоке — по 7 независимых бит вторичного хеша
+    // (двойное хеширование внутри 128 ячеек заметно хуже по доле ложных
+    // срабатываний). В одном 64-битном слове 9 проб, дальше — новое слово.
+    class Probes {
+    public:
+        explicit Probes(std::uint64_t hash) noexcept : seed_(hash) {
+        }
+
+        unsigned next() noexcept {
+            if (left_ == 0) {
+                seed_ += 0x9e3779b97f4a7c15ULL;
+                bits_ = mix(seed_);
+                left_ = 9;
+            }
+            --left_;
+            unsigned slot = bits_ % slots_per_block;
+            bits_ >>= 7;
+            return slot;
+        }
+
+    private:
+        std::uint64_t seed_;
+        std::uint64_t bits_ = 0;
+        unsigned left_ = 0;
+    };
+
+    template <typename F>
+    void for_each_slot(std::uint64_t hash, F f) noexcept {
+        Block &block = blocks_[block_of(hash)];
+        Probes probes(hash);
+        for (unsigned i = 0; i < hashes_; ++i) {
+            unsigned slot = probes.next();
+            f(block.words[slot / 16], slot % 16 * 4);
+        }
+    }
+
+    size_t capacity_;
+    double fp_rate_;
+    unsigned hashes_ = 1;
+    std::vector<Block> blocks_;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "avl-set.hpp"
+#include "key-codec.hpp"
+
+namespace my_algorithms {
+
+// AvlSet с журналом упреждающей записи в каталоге на локальном диске:
+//   wal        — записи insert/erase, дописываются в конец;
+//   checkpoint — снимок дерева в формате AvlSet::serialize.
+// insert/erase возвращаются, когда запись попала на диск, и только тогда
+// изменение становится видно читателям. Пока один поток делает fdatasync,
+// остальные копят записи в буфере, и следующий fdatasync сохраняет их все
+// разом (group commit). Ошибка write или fdatasync переводит журнал в отказ:
+// он обрезается до последней сохранённой записи, все ждущие и все
+// последующие изменения получают эту ошибку, а в памяти остаётся то, что
+// лежит на диске. При открытии загружается снимок и проигрывается хвост
+// журнала; оборванная последняя запись отбрасывается.
+template <
+    typename T,
+    typename Compare = std::less<T>,
+    typename Allocator = std::allocator<T>,
+    typename Codec = KeyCodec<T>>
+class DurableAvlSet {
+    using Set = AvlSet<T, Compare, Allocator>;
+
+    enum Kind : char { Insert = 'I', Erase = 'E' };
+
+    // Изменение, которое уже в журнале, но ещё не на диске.
+    struct Op {
+        Kind kind;
+        T value;
+        uint64_t lsn;
+    };
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+
+    struct Options {
+        // После стольких записей в журнале делается снимок (0 — никогда).
+        size_t checkpoint_every = 1 << 20;
+    };
+
+    struct Stats {
+        uint64_t records;
+        uint64_t syncs;
+        uint64_t checkpoints;
+        uint64_t recovered_records;
+    };
+
+    explicit DurableAvlSet(std::filesystem::path directory)
+        : DurableAvlSet(std::move(directory), Options()) {
+    }
+
+    DurableAvlSet(std::filesystem::path directory, Options options)
+        : directory_(std::move(directory)), options_(options) {
+        std::filesystem::create_directories(directory_);
+        recover();
+    }
+
+    DurableAvlSet(const DurableAvlSet &) = delete;
+    DurableAvlSet &operator=(const DurableAvlSet &) = delete;
+
+    ~DurableAvlSet() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    bool insert(const T &value) {
+        return update(Insert, value);
+    }
+
+    bool erase(const T &value) {
+        return update(Erase, value);
+    }
+
+    bool contains(const T &value) const {
+        std::lock_guard lock(mutex_);
+        return set_.contains(value);
+    }
+
+    size_t size() const {
+        std::lock_guard lock(mutex_);
+        return set_.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    template <typename F>
+    void for_each(F fn) const {
+        std::lock_guard lock(mutex_);
+        for (const T &value : set_) {
+            fn(value);
+        }
+    }
+
+    // Пишет снимок и обрезает журнал.
+    void checkpoint() {
+        std::unique_lock lock(mutex_);
+        checkpoint_locked(lock);
+    }
+
+    Stats stats() const {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+private:
+    std::filesystem::path wal_path() const {
+        return directory_ / "wal";
+    }
+
+    std::filesystem::path checkpoint_path() const {
+        return directory_ / "checkpoint";
+    }
+
+    static uint32_t checksum(const char *data, size_t n) noexcept {
+        uint32_t hash = 2166136261U;
+        for (size_t i = 0; i < n; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619U;
+        }
+        return hash;
+    }
+
+    // Запись: вид, varint длины ключа, ключ, 4 байта контрольной суммы.
+    void append_record(Kind kind, const T &value) {
+        std::ostringstream key;
+        codec_.encode(key, value, nullptr);
+        std::string payload = key.str();
+        std::ostringstream record;
+        record.put(kind);
+        write_varint(record, payload.size());
+        record.write(
+            payload.data(), static_cast<std::streamsize>(payload.size())
+        );
+        std::string bytes = record.str();
+        uint32_t sum = checksum(bytes.data(), bytes.size());
+        for (int i = 0; i < 4; ++i) {
+            bytes.push_back(static_cast<char>(sum >> (8 * i)));
+        }
+        pending_ += bytes;
+        ++stats_.records;
+        ++records_since_checkpoint_;
+    }
+
+    bool update(Kind kind, const T &value) {
+        std::unique_lock lock(mutex_);
+        throw_if_failed();
+        if (present(value) == (kind == Insert)) {
+            return false;
+        }
+        uint64_t lsn = next_lsn_ + 1;
+        inflight_.push_back(Op{kind, value, lsn});
+        try {
+            append_record(kind, value);
+        } catch (...) {
+            inflight_.pop_back();
+            throw;
+        }
+        next_lsn_ = lsn;
+        wait_durable(lock, lsn);
+        if (options_.checkpoint_every &&
+            records_since_checkpoint_ >= options_.checkpoint_every) {
+            checkpoint_locked(lock);
+        }
+        return true;
+    }
+
+    // Есть ли ключ с учётом изменений, ещё не дошедших до диска.
+    bool present(const T &value) const {
+        for (auto it = inflight_.rbegin(); it != inflight_.rend(); ++it) {
+            if (equivalent(it->value, value)) {
+                return it->kind == Insert;
+            }
+        }
+        return set_.contains(value);
+    }
+
+    bool equivalent(const T &a, const T &b) const {
+        if constexpr (detail::ThreeWayCompare<Compare, T>) {
+            return comp_(a, b) == 0;
+        } else {
+            return !comp_(a, b) && !comp_(b, a);
+        }
+    }
+
+    void throw_if_failed() const {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    // Лидер сбрасывает всё накопленное одним write + fdatasync и применяет
+    // сохранённые изменения к дереву, остальные ждут, пока их номер записи
+    // станет долговечным.
+    void wait_durable(std::unique_lock<std::mutex> &lock, uint64_t lsn) {
+        while (durable_lsn_ < lsn) {
+            throw_if_failed();
+            if (flushing_) {
+                flushed_.wait(lock);
+                continue;
+            }
+            flushing_ = true;
+            std::string batch;
+            batch.swap(pending_);
+            uint64_t target = next_lsn_;
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                write_all(fd_, batch);
+                sync(fd_);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (!error) {
+                log_size_ += batch.size();
+                ++stats_.syncs;
+                try {
+                    apply_durable(target);
+                    durable_lsn_ = target;
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            if (error) {
+                fail(error);
+            }
+            flushing_ = false;
+            flushed_.notify_all();
+            throw_if_failed();
+        }
+    }
+
+    void apply_durable(uint64_t target) {
+        size_t n = 0;
+        for (; n < inflight_.size() && inflight_[n].lsn <= target; ++n) {
+            if (inflight_[n].kind == Insert) {
+                set_.insert(inflight_[n].value);
+            } else {
+                set_.erase(inflight_[n].value);
+            }
+        }
+        inflight_.erase(inflight_.begin(), inflight_.begin() + n);
+    }
+
+    // Недописанная запись посреди журнала отрезала бы при восстановлении
+    // всё, что пишется после неё, поэтому журнал возвращается к последней
+    // сохранённой записи и больше не принимает изменений.
+    void fail(std::exception_ptr error) noexcept {
+        error_ = error;
+        pending_.clear();
+        inflight_.clear();
+        if (::ftruncate(fd_, static_cast<off_t>(log_size_)) == 0) {
+            ::fdatasync(fd_);
+        }
+    }
+
+    void checkpoint_locked(std::unique_lock<std::mutex> &lock) {
+        wait_durable(lock, next_lsn_);
+        while (flushing_) {
+            flushed_.wait(lock);
+        }
+        throw_if_failed();
+        auto tmp = directory_ / "checkpoint.tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            set_.serialize(out, codec_);
+            out.flush();
+            if (!out) {
+                throw std::runtime_error("DurableAvlSet: checkpoint failed");
+            }
+        }
+        sync_path(tmp);
+        std::filesystem::rename(tmp, checkpoint_path());
+        sync_path(directory_);
+        // Если упасть здесь, журнал проиграется поверх нового снимка ещё
+        // раз — это безопасно: итог по каждому ключу задаёт последняя запись.
+        if (::ftruncate(fd_, 0) != 0) {
+            throw_errno("ftruncate");
+        }
+        log_size_ = 0;
+        sync(fd_);
+        records_since_checkpoint_ = 0;
+        ++stats_.checkpoints;
+    }
+
+    void recover() {
+        if (std::filesystem::exists(checkpoint_path())) {
+            std::ifstream in(checkpoint_path(), std::ios::binary);
+            set_.deserialize(in, codec_);
+        }
+        fd_ = ::open(wal_path().c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd_ < 0) {
+            throw_errno("open wal");
+        }
+        std::ifstream in(wal_path(), std::ios::binary);
+        std::string log(
+            (std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>()
+        );
+        std::istringstream records(log);
+        size_t good = 0;
+        while (good < log.size()) {
+            auto record = read_record(log, records);
+            if (!record) {
+                break;
+            }
+            if (record->first == Insert) {
+                set_.insert(record->second);
+            } else {
+                set_.erase(record->second);
+            }
+            good = static_cast<size_t>(records.tellg());
+            ++stats_.recovered_records;
+            ++records_since_checkpoint_;
+        }
+        if (good != log.size()) {
+            if (::ftruncate(fd_, static_cast<off_t>(good)) != 0) {
+                throw_errno("ftruncate");
+            }
+            sync(fd_);
+        }
+        log_size_ = good;
+    }
+
+    std::optional<std::pair<Kind, T>>
+    read_record(const std::string &log, std::istream &in) const {
+        try {
+            auto start = static_cast<size_t>(in.tellg());
+            int kind = in.get();
+            if (kind != Insert && kind != Erase) {
+                return std::nullopt;
+            }
+            uint64_t length = read_varint(in);
+            std::string payload(length, '\0');
+            read_exact(in, payload.data(), payload.size());
+            char sum[4];
+            read_exact(in, sum, sizeof(sum));
+            auto end = static_cast<size_t>(in.tellg());
+            uint32_t expected = checksum(log.data() + start, end - start - 4);
+            for (int i = 0; i < 4; ++i) {
+                if (static_cast<char>(expected >> (8 * i)) != sum[i]) {
+                    return std::nullopt;
+                }
+            }
+            std::istringstream key(payload);
+            return std::pair<Kind, T>(
+                static_cast<Kind>(kind), codec_.decode(key, nullptr)
+            );
+        } catch (const std::runtime_error &) {
+            return std::nullopt;
+        } catch (const std::length_error &) {
+            return std::nullopt;
+        } catch (const std::bad_alloc &) {
+            return std::nullopt;
+        }
+    }
+
+    static void write_all(int fd, const std::string &data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw_errno("write wal");
+            }
+            done += static_cast<size_t>(n);
+        }
+    }
+
+    static void sync(int fd) {
+        if (::fdatasync(fd) != 0) {
+            throw_errno("fdatasync");
+        }
+    }
+
+    static void sync_path(const std::filesystem::path &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw_errno("open for fsync");
+        }
+        int res = ::fsync(fd);
+        ::close(fd);
+        if (res != 0) {
+            throw_errno("fsync");
+        }
+    }
+
+    [[noreturn]] static void throw_errno(const char *what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    std::filesystem::path directory_;
+    Options options_;
+    Codec codec_;
+    Compare comp_;
+    int fd_ = -1;
+
+    mutable std::mutex mutex_;
+    std::condition_variable flushed_;
+    bool flushing_ = false;
+    std::string pending_;
+    std::vector<Op> inflight_;
+    std::exception_ptr error_;
+    uint64_t next_lsn_ = 0;
+    uint64_t durable_lsn_ = 0;
+    size_t log_size_ = 0;  // длина журнала на диске без недописанного
+    size_t records_since_checkpoint_ = 0;
+    Stats stats_{};
+    Set set_;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace my_algorithms {
+
+// Epoch-based reclamation. Читатель входит в эпоху через EpochGuard, писатель
+// вместо немедленного освобождения отдаёт объект в retire(): он попадает в
+// limbo-список потока и освобождается, когда глобальная эпоха уйдёт на два
+// шага вперёд, то есть все читатели, которые могли его видеть, вышли.
+class EpochDomain {
+    struct Retired {
+        uint64_t epoch;
+        void *ptr;
+        void (*deleter)(void *context, void *ptr);
+        void *context;
+    };
+
+    struct Record;
+
+    // Записи потока во всех доменах, где он бывал. Домен при уничтожении
+    // снимает свою запись со списка, поэтому список не растёт.
+    struct ThreadRecords {
+        std::mutex mutex;
+        std::vector<std::pair<const EpochDomain *, Record *>> records;
+        // Последняя найденная запись: повторный pin() того же домена не
+        // ищет по списку и не берёт mutex. Меняется только под mutex.
+        std::atomic<const EpochDomain *> last_domain{nullptr};
+        std::atomic<Record *> last_record{nullptr};
+    };
+
+    struct alignas(64) Record {
+        // (эпоха << 1) | 1, пока поток внутри эпохи, иначе 0.
+        std::atomic<uint64_t> state{0};
+        std::atomic<bool> in_use{true};
+        size_t nesting = 0;
+        // Поток, которому принадлежит запись; меняется под records_mutex_.
+        std::shared_ptr<ThreadRecords> owner;
+        std::mutex limbo_mutex;
+        std::vector<Retired> limbo;
+        // Размер limbo, при котором retire() запустит сборку.
+        size_t next_collect = collect_threshold;
+    };
+
+    // При выходе потока его записи остаются доменам вместе с limbo.
+    struct ThreadExit {
+        std::shared_ptr<ThreadRecords> list =
+            std::make_shared<ThreadRecords>();
+
+        ~ThreadExit() {
+            std::lock_guard lock(list->mutex);
+            for (auto &[domain, record] : list->records) {
+                record->in_use.store(false, std::memory_order_release);
+            }
+            list->records.clear();
+            list->last_domain.store(nullptr, std::memory_order_relaxed);
+            list->last_record.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+public:
+    class EpochGuard {
+    public:
+        explicit EpochGuard(EpochDomain &domain)
+            : domain_(&domain), record_(&domain.local_record()) {
+            domain_->enter(*record_);
+        }
+
+        EpochGuard(const EpochGuard &) = delete;
+        EpochGuard &operator=(const EpochGuard &) = delete;
+
+        ~EpochGuard() {
+            domain_->leave(*record_);
+        }
+
+    private:
+        EpochDomain *domain_;
+        Record *record_;
+    };
+
+    static constexpr size_t collect_threshold = 64;
+
+    EpochDomain() = default;
+
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    // Вызывается, когда никто уже не читает и не пишет.
+    ~EpochDomain() {
+        for (auto &record : records_) {
+            {
+                ThreadRecords &list = *record->owner;
+                std::lock_guard lock(list.mutex);
+                std::erase_if(list.records, [this](const auto &entry) {
+                    return entry.first == this;
+                });
+                if (list.last_domain.load(std::memory_order_relaxed) ==
+                    this) {
+                    list.last_domain.store(nullptr, std::memory_order_relaxed);
+                    list.last_record.store(nullptr, std::memory_order_relaxed);
+                }
+            }
+            std::lock_guard lock(record->limbo_mutex);
+            for (Retired &item : record->limbo) {
+                item.deleter(item.context, item.ptr);
+            }
+            record->limbo.clear();
+        }
+    }
+
+    EpochGuard pin() {
+        return EpochGuard(*this);
+    }
+
+    // deleter(context, ptr) будет вызван, когда ptr никто не сможет читать.
+    // Сборка, которую запускает retire(), вызывает удалители только этого
+    // context: данные других владельцев меняют их собственные писатели.
+    void retire(void *ptr, void (*deleter)(void *, void *), void *context) {
+        Record &record = local_record();
+        bool due = false;
+        {
+            std::lock_guard lock(record.limbo_mutex);
+            record.limbo.push_back(
+                {global_epoch_.load(std::memory_order_acquire), ptr, deleter,
+                 context}
+            );
+            due = record.limbo.size() >= record.next_collect;
+        }
+        if (!due) {
+            return;
+        }
+        collect(context);
+        // Чужие объекты в limbo могут лежать долго; сборка — через
+        // collect_threshold новых, а не на каждом retire().
+        std::lock_guard lock(record.limbo_mutex);
+        record.next_collect = record.limbo.size() + collect_threshold;
+    }
+
+    // Пытается сдвинуть эпоху и освобождает всё, что уже безопасно.
+    // Вызывает удалители всех владельцев на этом потоке.
+    void collect() {
+        try_advance();
+        uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+        for (Record *record : snapshot()) {
+            reclaim(*record, [epoch](const Retired &item) {
+                return item.epoch + 2 <= epoch;
+            });
+        }
+    }
+
+    // То же, но только для объектов, отданных с этим context.
+    void collect(void *context) {
+        try_advance();
+        uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+        for (Record *record : snapshot()) {
+            reclaim(*record, [epoch, context](const Retired &item) {
+                return item.context == context && item.epoch + 2 <= epoch;
+            });
+        }
+    }
+
+    // Сразу, не дожидаясь читателей, освобождает всё, что отдано с этим
+    // context. Для владельца, объекты которого уже никто не может читать:
+    // например, из его деструктора.
+    void purge(void *context) {
+        for (Record *record : snapshot()) {
+            reclaim(*record, [context](const Retired &item) {
+                return item.context == context;
+            });
+        }
+    }
+
+    // Ждёт, пока всё отложенное будет освобождено. Изнутри EpochGuard
+    // этого домена ожидание не кончилось бы никогда, поэтому там бросает
+    // std::logic_error.
+    void drain() {
+        if (local_record().nesting > 0) {
+            throw std::logic_error("EpochDomain::drain inside an EpochGuard");
+        }
+        while (true) {
+            collect();
+            if (pending() == 0) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    uint64_t epoch() const noexcept {
+        return global_epoch_.load(std::memory_order_acquire);
+    }
+
+    size_t pending() {
+        size_t res = 0;
+        for (Record *record : snapshot()) {
+            std::lock_guard lock(record->limbo_mutex);
+            res += record->limbo.size();
+        }
+        return res;
+    }
+
+    // Число живых доменов, в которых зарегистрирован вызывающий поток.
+    static size_t thread_domains() {
+        ThreadRecords &list = *thread_records().list;
+        std::lock_guard lock(list.mutex);
+        return list.records.size();
+    }
+
+private:
+    static ThreadExit &thread_records() {
+        static thread_local ThreadExit local;
+        return local;
+    }
+
+    void enter(Record &record) noexcept {
+        if (record.nesting++ > 0) {
+            return;
+        }
+        uint64_t epoch = global_epoch_.load(std::memory_order_relaxed);
+        record.state.store((epoch << 1) | 1, std::memory_order_seq_cst);
+        // Эпоха могла сдвинуться между чтением и публикацией — перечитываем.
+        uint64_t now = global_epoch_.load(std::memory_order_seq_cst);
+        if (now != epoch) {
+            record.state.store((now << 1) | 1, std::memory_order_seq_cst);
+        }
+    }
+
+    void leave(Record &record) noexcept {
+        if (--record.nesting > 0) {
+            return;
+        }
+        record.state.store(0, std::memory_order_release);
+    }
+
+    bool try_advance() {
+        uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+        for (Record *record : snapshot()) {
+            uint64_t state = record->state.load(std::memory_order_seq_cst);
+            if ((state & 1) && (state >> 1) != epoch) {
+                return false;
+            }
+        }
+        return global_epoch_.compare_exchange_strong(
+            epoch, epoch + 1, std::memory_order_seq_cst
+        );
+    }
+
+    // Забирает из limbo всё, что подходит под ready, и вызывает удалители
+    // уже без замка.
+    template <typename Ready>
+    void reclaim(Record &record, Ready ready) {
+        std::vector<Retired> res;
+        {
+            std::lock_guard lock(record.limbo_mutex);
+            size_t kept = 0;
+            for (Retired &item : record.limbo) {
+                if (ready(item)) {
+                    res.push_back(item);
+                } else {
+                    record.limbo[kept++] = item;
+                }
+            }
+            record.limbo.resize(kept);
+        }
+        for (Retired &item : res) {
+            item.deleter(item.context, item.ptr);
+        }
+    }
+
+    std::vector<Record *> snapshot() {
+        std::lock_guard lock(records_mutex_);
+        std::vector<Record *> res;
+        res.reserve(records_.size());
+        for (auto &record : records_) {
+            res.push_back(record.get());
+        }
+        return res;
+    }
+
+    Record &local_record() {
+        ThreadExit &local = thread_records();
+        ThreadRecords &list = *local.list;
+        if (list.last_domain.load(std::memory_order_relaxed) == this) {
+            return *list.last_record.load(std::memory_order_relaxed);
+        }
+        std::lock_guard list_lock(list.mutex);
+        Record *record = nullptr;
+        for (auto &[domain, candidate] : list.records) {
+            if (domain == this) {
+                record = candidate;
+                break;
+            }
+        }
+        if (!record) {
+            std::lock_guard lock(records_mutex_);
+            // Подбираем запись завершившегося потока вместе с её limbo.
+            for (auto &candidate : records_) {
+                bool expected = false;
+                if (candidate->in_use.compare_exchange_strong(expected, true)) {
+                    record = candidate.get();
+                    break;
+                }
+            }
+            if (!record) {
+                records_.push_back(std::make_unique<Record>());
+                record = records_.back().get();
+            }
+            record->owner = local.list;
+            list.records.emplace_back(this, record);
+        }
+        list.last_record.store(record, std::memory_order_relaxed);
+        list.last_domain.store(this, std::memory_order_relaxed);
+        return *record;
+    }
+
+    alignas(64) std::atomic<uint64_t> global_epoch_{0};
+    std::mutex records_mutex_;
+    std::vector<std::unique_ptr<Record>> records_;
+};
+
+using EpochGuard = EpochDomain::EpochGuard;
+
+}  // namespace my_algorithms
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "avl-set.hpp"
+
+namespace my_algorithms {
+
+// Flat combining поверх AvlSet: потоки публикуют операции в слоты, один
+// из них (комбайнер) забирает все ожидающие операции, сортирует их по ключу
+// и применяет к дереву подряд, остальные ждут результат в своём слоте.
+// Исключение из операции (bad_alloc, бросающий компаратор) доставляется
+// через слот тому потоку, который её опубликовал.
+template <
+    typename T,
+    typename Compare = std::less<T>,
+    typename Allocator = std::allocator<T>,
+    std::size_t Slots = 64>
+class FlatCombiningAvlSet {
+    using Set = AvlSet<T, Compare, Allocator>;
+
+    enum class Op : uint8_t { Insert, Erase, Contains };
+
+    enum State : uint32_t { Free, Claimed, Pending, Done };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> state{Free};
+        Op op = Op::Contains;
+        const T *value = nullptr;
+        bool result = false;
+        std::exception_ptr error;
+    };
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+
+    struct Stats {
+        uint64_t passes;
+        uint64_t operations;
+    };
+
+    FlatCombiningAvlSet() {
+        pending_.reserve(Slots);
+    }
+
+    FlatCombiningAvlSet(const FlatCombiningAvlSet &) = delete;
+    FlatCombiningAvlSet &operator=(const FlatCombiningAvlSet &) = delete;
+
+    bool insert(const T &value) {
+        return publish(Op::Insert, value);
+    }
+
+    bool erase(const T &value) {
+        return publish(Op::Erase, value);
+    }
+
+    bool contains(const T &value) {
+        return publish(Op::Contains, value);
+    }
+
+    size_t size() {
+        lock();
+        Unlock guard{this};
+        return set_.size();
+    }
+
+    bool empty() {
+        return size() == 0;
+    }
+
+    // Упорядоченный обход под замком комбайнера.
+    template <typename F>
+    void for_each(F fn) {
+        lock();
+        Unlock guard{this};
+        for (const T &value : set_) {
+            fn(value);
+        }
+    }
+
+    Stats stats() const noexcept {
+        return {
+            passes_.load(std::memory_order_relaxed),
+            operations_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    // Снимает замок комбайнера при выходе из области, в том числе по
+    // исключению: иначе все ждущие потоки крутились бы вечно.
+    struct Unlock {
+        FlatCombiningAvlSet *set;
+
+        ~Unlock() {
+            set->unlock();
+        }
+    };
+
+    bool publish(Op op, const T &value) {
+        Slot &slot = claim_slot();
+        slot.op = op;
+        slot.value = &value;
+        slot.state.store(Pending, std::memory_order_release);
+
+        for (size_t spins = 0;; ++spins) {
+            if (slot.state.load(std::memory_order_acquire) == Done) {
+                bool res = slot.result;
+                std::exception_ptr error = std::move(slot.error);
+                slot.error = nullptr;
+                slot.state.store(Free, std::memory_order_release);
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+                return res;
+            }
+            if (try_lock()) {
+                Unlock guard{this};
+                combine();
+                continue;
+            }
+            if (spins % 64 == 63) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    Slot &claim_slot() {
+        static thread_local const size_t hint =
+            std::hash<std::thread::id>()(std::this_thread::get_id());
+        while (true) {
+            for (size_t i = 0; i < Slots; ++i) {
+                Slot &slot = slots_[(hint + i) % Slots];
+                uint32_t expected = Free;
+                if (slot.state.load(std::memory_order_relaxed) == Free &&
+                    slot.state.compare_exchange_strong(
+                        expected, Claimed, std::memory_order_acquire
+                    )) {
+                    return slot;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void collect_pending() {
+        pending_.clear();
+        for (Slot &slot : slots_) {
+            if (slot.state.load(std::memory_order_acquire) == Pending) {
+                pending_.push_back(&slot);
+            }
+        }
+    }
+
+    void combine() {
+        collect_pending();
+        // Применяем по возрастанию ключа: соседние операции идут по
+        // соседним узлам, которые уже в кэше. Операции одного прохода
+        // конкурентны, так что порядок равных ключей не важен, и
+        // std::sort не выделяет память, в отличие от stable_sort. Если
+        // сортировка бросила, операции применяются в порядке слотов, и
+        // исключение получит только та, на ключе которой оно повторится.
+        if (pending_.size() > 1) {
+            try {
+                std::sort(
+                    pending_.begin(), pending_.end(),
+                    [this](const Slot *a, const Slot *b) {
+                        return comp_(*a->value, *b->value);
+                    }
+                );
+            } catch (...) {
+                collect_pending();
+            }
+        }
+        for (Slot *slot : pending_) {
+            try {
+                slot->result = apply(slot->op, *slot->value);
+            } catch (...) {
+                slot->error = std::current_exception();
+            }
+            slot->state.store(Done, std::memory_order_release);
+        }
+        passes_.fetch_add(1, std::memory_order_relaxed);
+        operations_.fetch_add(pending_.size(), std::memory_order_relaxed);
+    }
+
+    bool apply(Op op, const T &value) {
+        size_t before = set_.size();
+        switch (op) {
+            case Op::Insert:
+                set_.insert(value);
+                return set_.size() != before;
+            case Op::Erase:
+                set_.erase(value);
+                return set_.size() != before;
+            case Op::Contains:
+                return set_.contains(value);
+        }
+        return false;
+    }
+
+    bool try_lock() noexcept {
+        return !combining_.load(std::memory_order_relaxed) &&
+               !combining_.exchange(true, std::memory_order_acquire);
+    }
+
+    void lock() noexcept {
+        while (!try_lock()) {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock() noexcept {
+        combining_.store(false, std::memory_order_release);
+    }
+
+    std::array<Slot, Slots> slots_;
+    alignas(64) std::atomic<bool> combining_{false};
+    std::atomic<uint64_t> passes_{0};
+    std::atomic<uint64_t> operations_{0};
+    std::vector<Slot *> pending_;
+    Set set_;
+    Compare comp_;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace my_algorithms {
+
+// Хеш-таблица с открытой адресацией и линейным пробированием: хеш ключа ->
+// указатель на объект, владеет которым кто-то другой. Хеш должен быть уже
+// хорошо перемешан — позиция берётся из младших бит. Заполнение держится
+// не выше половины; удаление — обратным сдвигом, без надгробий.
+template <typename Value>
+class HashIndex {
+    struct Slot {
+        std::uint64_t hash;
+        Value *value;
+    };
+
+public:
+    explicit HashIndex(size_t expected = 0) {
+        slots_.resize(std::bit_ceil(std::max<size_t>(2 * expected, 16)));
+    }
+
+    // Первый объект с таким хешем, для которого equal(value) истинно.
+    template <typename Equal>
+    Value *find(std::uint64_t hash, Equal equal) const {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot &slot = slots_[i];
+            if (!slot.value) {
+                return nullptr;
+            }
+            if (slot.hash == hash && equal(slot.value)) {
+                return slot.value;
+            }
+        }
+    }
+
+    // Объекта с таким ключом в индексе быть не должно.
+    void insert(std::uint64_t hash, Value *value) {
+        if (2 * (size_ + 1) > slots_.size()) {
+            rehash(2 * slots_.size());
+        }
+        place(hash, value);
+        ++size_;
+    }
+
+    bool erase(std::uint64_t hash, const Value *value) noexcept {
+        size_t mask = slots_.size() - 1;
+        size_t i = hash & mask;
+        while (slots_[i].value != value) {
+            if (!slots_[i].value) {
+                return false;
+            }
+            i = (i + 1) & mask;
+        }
+        // Сдвигаем назад элементы цепочки, которые могут занять дыру.
+        for (size_t j = (i + 1) & mask; slots_[j].value; j = (j + 1) & mask) {
+            size_t home = slots_[j].hash & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i] = Slot{0, nullptr};
+        --size_;
+        return true;
+    }
+
+    // Объект переехал по другому адресу.
+    void replace(std::uint64_t hash, const Value *old, Value *fresh) noexcept {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask; slots_[i].value; i = (i + 1) & mask) {
+            if (slots_[i].value == old) {
+                slots_[i].value = fresh;
+                return;
+            }
+        }
+    }
+
+    void clear() noexcept {
+        std::fill(slots_.begin(), slots_.end(), Slot{0, nullptr});
+        size_ = 0;
+    }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    size_t memory_bytes() const noexcept {
+        return slots_.size() * sizeof(Slot);
+    }
+
+private:
+    void place(std::uint64_t hash, Value *value) noexcept {
+        size_t mask = slots_.size() - 1;
+        size_t i = hash & mask;
+        while (slots_[i].value) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = Slot{hash, value};
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old(capacity, Slot{0, nullptr});
+        old.swap(slots_);
+        for (const Slot &slot : old) {
+            if (slot.value) {
+                place(slot.hash, slot.value);
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace my_algorithms {
+
+// Кеш горячих ключей: хеш ключа -> указатель на объект, владеет которым
+// кто-то другой. Четырёхканальный, один набор — одна кеш-линия; новая
+// запись встаёт в начало набора, последняя вытесняется. Попадание ничего не
+// пишет. Читать и пополнять кеш можно из нескольких потоков сразу: ячейки
+// атомарные, а найденный объект всё равно проверяется через equal, так что
+// разорванная пара (хеш, указатель) даёт только промах.
+template <typename Value>
+class HotKeyCache {
+    static constexpr size_t ways = 4;
+
+    struct Entry {
+        std::atomic<std::uint64_t> hash{0};
+        std::atomic<Value *> value{nullptr};
+    };
+
+    struct alignas(64) Set {
+        Entry entries[ways];
+    };
+
+public:
+    explicit HotKeyCache(size_t capacity)
+        : sets_(std::bit_ceil(std::max<size_t>(capacity / ways, 1))),
+          table_(std::make_unique<Set[]>(sets_)) {
+    }
+
+    template <typename Equal>
+    Value *find(std::uint64_t hash, Equal equal) const noexcept {
+        const Set &set = set_of(hash);
+        for (const Entry &entry : set.entries) {
+            Value *value = entry.value.load(std::memory_order_relaxed);
+            if (value && entry.hash.load(std::memory_order_relaxed) == hash &&
+                equal(value)) {
+                return value;
+            }
+        }
+        return nullptr;
+    }
+
+    void put(std::uint64_t hash, Value *value) noexcept {
+        Set &set = set_of(hash);
+        for (size_t i = ways - 1; i > 0; --i) {
+            const Entry &prev = set.entries[i - 1];
+            store(
+                set.entries[i], prev.hash.load(std::memory_order_relaxed),
+                prev.value.load(std::memory_order_relaxed)
+            );
+        }
+        store(set.entries[0], hash, value);
+    }
+
+    // Объект удаляется или переезжает: запись о нём не должна пережить его.
+    void forget(std::uint64_t hash, const Value *value) noexcept {
+        replace(hash, value, nullptr);
+    }
+
+    void replace(std::uint64_t hash, const Value *old, Value *fresh) noexcept {
+        for (Entry &entry : set_of(hash).entries) {
+            if (entry.value.load(std::memory_order_relaxed) == old) {
+                entry.value.store(fresh, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void clear() noexcept {
+        for (size_t i = 0; i < sets_; ++i) {
+            for (Entry &entry : table_[i].entries) {
+                store(entry, 0, nullptr);
+            }
+        }
+    }
+
+    size_t capacity() const noexcept {
+        return sets_ * ways;
+    }
+
+    size_t memory_bytes() const noexcept {
+        return sets_ * sizeof(Set);
+    }
+
+private:
+    Set &set_of(std::uint64_t hash) const noexcept {
+        return table_[hash & (sets_ - 1)];
+    }
+
+    static void store(Entry &entry, std::uint64_t hash, Value *value) noexcept {
+        entry.value.store(nullptr, std::memory_order_relaxed);
+        entry.hash.store(hash, std::memory_order_relaxed);
+        entry.value.store(value, std::memory_order_relaxed);
+    }
+
+    size_t sets_;
+    std::unique_ptr<Set[]> table_;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace my_algorithms {
+
+// Хранилище объектов одного типа, адресуемых 32-битным индексом. Память
+// выделяется страницами по page_bytes байт, выровненными по своему размеру;
+// страницы собраны в куски, которые никогда не переезжают: кусок k держит
+// 2^k страниц. Индекс — номер страницы в старших битах и номер ячейки в
+// младших, поэтому оба преобразования стоят O(1): индекс -> адрес через
+// таблицу кусков, адрес -> индекс через заголовок в нулевой ячейке
+// страницы. Индекс 0 (заголовок первой страницы) обозначает nullptr.
+// Освобождённые ячейки идут в список свободных. На каждую пару (T, Tag) —
+// одна арена на всю программу.
+template <typename T, typename Tag = void>
+class IndexArena {
+    static_assert(sizeof(T) >= sizeof(std::uint32_t));
+
+public:
+    static constexpr size_t page_bytes =
+        std::bit_ceil(std::max<size_t>(4096, 16 * sizeof(T)));
+    // Ячеек на странице вместе с заголовком.
+    static constexpr size_t cells_per_page = page_bytes / sizeof(T);
+
+private:
+    static constexpr unsigned cell_bits = std::bit_width(cells_per_page - 1);
+    static constexpr std::uint32_t cell_mask = (1u << cell_bits) - 1;
+    static constexpr size_t max_chunks = 33 - cell_bits;
+
+public:
+    static IndexArena &instance() {
+        // Не разрушается: множества в статических объектах могут пережить
+        // обычную статическую переменную.
+        static IndexArena *arena = new IndexArena;
+        return *arena;
+    }
+
+    static T *address(std::uint32_t index) noexcept {
+        size_t page = index >> cell_bits;
+        size_t k = std::bit_width(page + 1) - 1;
+        std::byte *chunk = chunks_[k].load(std::memory_order_acquire);
+        return reinterpret_cast<T *>(
+            chunk + (page + 1 - (size_t(1) << k)) * page_bytes +
+            (index & cell_mask) * sizeof(T)
+        );
+    }
+
+    // ptr должен указывать на ячейку, выданную этой ареной.
+    static std::uint32_t index(const T *ptr) noexcept {
+        auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+        auto page = addr & ~std::uintptr_t(page_bytes - 1);
+        std::uint32_t first;
+        std::memcpy(
+            &first, reinterpret_cast<const void *>(page), sizeof(first)
+        );
+        return first | static_cast<std::uint32_t>((addr - page) / sizeof(T));
+    }
+
+    T *allocate() {
+        std::lock_guard lock(mutex_);
+        if (free_) {
+            T *slot = address(free_);
+            std::memcpy(&free_, static_cast<void *>(slot), sizeof(free_));
+            return slot;
+        }
+        if (next_ >> 32) {
+            throw std::bad_alloc();  // все страницы заняты
+        }
+        auto res = static_cast<std::uint32_t>(next_);
+        if ((res & cell_mask) == 1) {
+            start_page(res >> cell_bits);
+        }
+        next_ = (res & cell_mask) + 1 < cells_per_page
+                    ? next_ + 1
+                    : (((next_ >> cell_bits) + 1) << cell_bits) | 1;
+        ++issued_;
+        return address(res);
+    }
+
+    void deallocate(T *ptr) noexcept {
+        std::lock_guard lock(mutex_);
+        std::memcpy(static_cast<void *>(ptr), &free_, sizeof(free_));
+        free_ = index(ptr);
+    }
+
+    // Сколько ячеек когда-либо выдано (вместе с освобождёнными).
+    size_t capacity_used() const noexcept {
+        std::lock_guard lock(mutex_);
+        return issued_;
+    }
+
+private:
+    IndexArena() = default;
+
+    // Выделяет кусок со страницей page, если его ещё нет, и пишет в
+    // заголовок страницы индекс её нулевой ячейки.
+    void start_page(size_t page) {
+        size_t k = std::bit_width(page + 1) - 1;
+        if (k == chunk_count_) {
+            auto *chunk = static_cast<std::byte *>(::operator new(
+                (size_t(1) << k) * page_bytes, std::align_val_t(page_bytes)
+            ));
+            chunks_[k].store(chunk, std::memory_order_release);
+            ++chunk_count_;
+        }
+        auto first = static_cast<std::uint32_t>(page << cell_bits);
+        std::memcpy(
+            static_cast<void *>(address(first)), &first, sizeof(first)
+        );
+    }
+
+    // Таблица кусков — статическая и инициализируется константой: чтение
+    // по индексу не проходит через instance().
+    static constinit inline std::atomic<std::byte *> chunks_[max_chunks] = {};
+
+    size_t chunk_count_ = 0;
+    mutable std::mutex mutex_;
+    std::uint64_t next_ = 1;
+    std::uint32_t free_ = 0;
+    size_t issued_ = 0;
+};
+
+// Ссылка на объект в IndexArena<T, Tag>: 4 байта вместо 8 и не зависит от
+// адреса, по которому лежит арена. Приводится к T * и обратно.
+template <typename T, typename Tag = void>
+class IndexPtr {
+public:
+    using element_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    template <typename U>
+    using rebind = IndexPtr<U, Tag>;
+
+    IndexPtr() noexcept = default;
+
+    IndexPtr(std::nullptr_t) noexcept {
+    }
+
+    IndexPtr(T *ptr) noexcept
+        : index_(ptr ? IndexArena<T, Tag>::index(ptr) : 0) {
+    }
+
+    T *get() const noexcept {
+        return index_ ? IndexArena<T, Tag>::address(index_) : nullptr;
+    }
+
+    operator T *() const noexcept {
+        return get();
+    }
+
+    T *operator->() const noexcept {
+        return get();
+    }
+
+    template <typename U = T>
+        requires(!std::is_void_v<U>)
+    U &operator*() const noexcept {
+        return *get();
+    }
+
+    template <typename U = T>
+        requires(!std::is_void_v<U>)
+    static IndexPtr pointer_to(U &value) noexcept {
+        return IndexPtr(std::addressof(value));
+    }
+
+    std::uint32_t index() const noexcept {
+        return index_;
+    }
+
+private:
+    std::uint32_t index_ = 0;
+};
+
+// Аллокатор узлов поверх IndexArena: AvlSet<T, Compare, IndexAllocator<T>>
+// хранит ссылки между узлами 32-битными индексами. Выделяет только по
+// одному объекту — ровно так, как контейнер выделяет узлы. Разные Tag
+// дают независимые арены.
+template <typename T, typename Tag = void>
+class IndexAllocator {
+public:
+    using value_type = T;
+    using pointer = IndexPtr<T, Tag>;
+    using void_pointer = IndexPtr<void, Tag>;
+    using is_always_equal = std::true_type;
+    using allocates_single = std::true_type;  // allocate(n) только с n == 1
+
+    template <typename U>
+    struct rebind {
+        using other = IndexAllocator<U, Tag>;
+    };
+
+    IndexAllocator() noexcept = default;
+
+    template <typename U>
+    IndexAllocator(const IndexAllocator<U, Tag> &) noexcept {
+    }
+
+    pointer allocate(size_t n) {
+        if (n != 1) {
+            throw std::bad_alloc();
+        }
+        return pointer(IndexArena<T, Tag>::instance().allocate());
+    }
+
+    void deallocate(pointer p, size_t) noexcept {
+        IndexArena<T, Tag>::instance().deallocate(p.get());
+    }
+
+    friend bool operator==(const IndexAllocator &, const IndexAllocator &) {
+        return true;
+    }
+};
+
+}  // namespace my_algorithms
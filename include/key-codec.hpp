@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace my_algorithms {
+
+// Беззнаковый LEB128.
+inline void write_varint(std::ostream &out, std::uint64_t value) {
+    char buf[10];
+    size_t n = 0;
+    do {
+        auto byte = static_cast<unsigned char>(value & 0x7F);
+        value >>= 7;
+        buf[n++] = static_cast<char>(value ? byte | 0x80 : byte);
+    } while (value);
+    out.write(buf, static_cast<std::streamsize>(n));
+}
+
+inline std::uint64_t read_varint(std::istream &in) {
+    std::uint64_t res = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == std::istream::traits_type::eof()) {
+            throw std::runtime_error("varint: unexpected end of stream");
+        }
+        res |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return res;
+        }
+    }
+    throw std::runtime_error("varint: value is too long");
+}
+
+inline void read_exact(std::istream &in, char *data, size_t n) {
+    if (!in.read(data, static_cast<std::streamsize>(n))) {
+        throw std::runtime_error("unexpected end of stream");
+    }
+}
+
+// Кодек ключа для сериализации. Ключи пишутся по порядку, и кодек получает
+// предыдущий ключ (nullptr для первого), чтобы писать разность с ним.
+// id записывается в заголовок и проверяется при чтении.
+template <typename T, typename = void>
+struct KeyCodec {
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "provide a KeyCodec specialization for this key type"
+    );
+
+    static constexpr std::uint8_t id = 1;
+
+    void encode(std::ostream &out, const T &value, const T *) const {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    T decode(std::istream &in, const T *) const {
+        T value;
+        read_exact(in, reinterpret_cast<char *>(&value), sizeof(T));
+        return value;
+    }
+};
+
+// Целые: zigzag-varint разности с предыдущим ключом.
+template <typename T>
+struct KeyCodec<
+    T,
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    using Unsigned = std::make_unsigned_t<T>;
+
+    static constexpr std::uint8_t id = 2;
+
+    void encode(std::ostream &out, const T &value, const T *prev) const {
+        auto delta = static_cast<std::uint64_t>(
+            static_cast<Unsigned>(value) -
+            static_cast<Unsigned>(prev ? *prev : T())
+        );
+        if constexpr (sizeof(T) < sizeof(std::uint64_t)) {
+            // Расширяем со знаком, чтобы маленькие отрицательные шаги
+            // (обратный порядок) тоже кодировались коротко.
+            delta = static_cast<std::uint64_t>(static_cast<std::int64_t>(
+                static_cast<std::make_signed_t<Unsigned>>(delta)
+            ));
+        }
+        auto sdelta = static_cast<std::int64_t>(delta);
+        write_varint(
+            out, (static_cast<std::uint64_t>(sdelta) << 1) ^
+                     static_cast<std::uint64_t>(sdelta >> 63)
+        );
+    }
+
+    T decode(std::istream &in, const T *prev) const {
+        std::uint64_t zigzag = read_varint(in);
+        std::uint64_t delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+        return static_cast<T>(
+            static_cast<Unsigned>(prev ? *prev : T()) +
+            static_cast<Unsigned>(delta)
+        );
+    }
+};
+
+// bool: один байт 0 или 1; другие значения при чтении — ошибка, а не
+// bool с невозможным представлением.
+template <>
+struct KeyCodec<bool> {
+    static constexpr std::uint8_t id = 4;
+
+    void encode(std::ostream &out, const bool &value, const bool *) const {
+        out.put(value ? 1 : 0);
+    }
+
+    bool decode(std::istream &in, const bool *) const {
+        int byte = in.get();
+        if (byte == std::istream::traits_type::eof()) {
+            throw std::runtime_error("bool key: unexpected end of stream");
+        }
+        if (byte != 0 && byte != 1) {
+            throw std::runtime_error("bool key: bad value");
+        }
+        return byte == 1;
+    }
+};
+
+// Строки: длина общего префикса с предыдущим ключом и остаток.
+template <>
+struct KeyCodec<std::string> {
+    static constexpr std::uint8_t id = 3;
+
+    void encode(
+        std::ostream &out,
+        const std::string &value,
+        const std::string *prev
+    ) const {
+        size_t common = 0;
+        if (prev) {
+            size_t n = std::min(prev->size(), value.size());
+            while (common < n && (*prev)[common] == value[common]) {
+                ++common;
+            }
+        }
+        write_varint(out, common);
+        write_varint(out, value.size() - common);
+        out.write(
+            value.data() + common,
+            static_cast<std::streamsize>(value.size() - common)
+        );
+    }
+
+    std::string decode(std::istream &in, const std::string *prev) const {
+        std::uint64_t common = read_varint(in);
+        std::uint64_t rest = read_varint(in);
+        if (common > (prev ? prev->size() : 0)) {
+            throw std::runtime_error("string key: bad shared prefix");
+        }
+        std::string value(prev ? prev->substr(0, common) : std::string());
+        value.resize(common + rest);
+        read_exact(in, value.data() + common, rest);
+        return value;
+    }
+};
+
+}  // namespace my_algorithms
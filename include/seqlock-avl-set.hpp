@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "avl-set.hpp"
+#include "epoch-reclamation.hpp"
+
+namespace my_algorithms {
+
+// AvlSet для редких записей и очень частых чтений. Писатели сериализуются
+// мьютексом и обрамляют изменение нечётным значением seq_. Читатели не
+// делают ни одной атомарной RMW-операции: читают seq_, идут по дереву и
+// повторяют попытку, если seq_ изменился. Узлы освобождаются через
+// EpochDomain, поэтому читатель никогда не разыменует освобождённую память;
+// проход по дереву ограничен по числу шагов на случай, если во время
+// поворота он увидел временный цикл. Как и в любом seqlock, чтение узлов
+// параллельно с записью формально является гонкой данных — результат такой
+// попытки отбрасывается.
+template <
+    typename T,
+    typename Compare = std::less<T>,
+    typename Allocator = std::allocator<T>>
+class SeqlockAvlSet {
+    using Set = AvlSet<T, Compare, Allocator>;
+    using Node = typename Set::Node;
+
+    // Высота AVL-дерева не больше 1.44 * log2(n + 2), 128 с запасом.
+    static constexpr size_t step_limit = 128;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+
+    SeqlockAvlSet() {
+        set_.set_epoch_domain(&domain_);
+    }
+
+    SeqlockAvlSet(const SeqlockAvlSet &) = delete;
+    SeqlockAvlSet &operator=(const SeqlockAvlSet &) = delete;
+
+    void insert(const T &value) {
+        write([&] { set_.insert(value); });
+    }
+
+    void erase(const T &value) {
+        write([&] { set_.erase(value); });
+    }
+
+    void clear() {
+        write([&] { set_.clear(); });
+    }
+
+    bool contains(const T &value) const {
+        return read([&](bool &ok) { return find_node(value, ok) != nullptr; });
+    }
+
+    std::optional<T> find(const T &value) const {
+        return read([&](bool &ok) {
+            const Node *v = find_node(value, ok);
+            return v ? std::optional<T>(v->value) : std::nullopt;
+        });
+    }
+
+    std::optional<T> lower_bound(const T &value) const {
+        return read([&](bool &ok) {
+            auto key = Set::probe(value);
+            const Node *res = nullptr;
+            const Node *v = set_.root_;
+            for (size_t steps = 0; v; ++steps) {
+                if (steps == step_limit) {
+                    ok = false;
+                    return std::optional<T>();
+                }
+                if (!set_.less_(v, key)) {
+                    res = v;
+                    v = v->left;
+                } else {
+                    v = v->right;
+                }
+            }
+            return res ? std::optional<T>(res->value) : std::nullopt;
+        });
+    }
+
+    std::optional<T> upper_bound(const T &value) const {
+        return read([&](bool &ok) {
+            auto key = Set::probe(value);
+            const Node *res = nullptr;
+            const Node *v = set_.root_;
+            for (size_t steps = 0; v; ++steps) {
+                if (steps == step_limit) {
+                    ok = false;
+                    return std::optional<T>();
+                }
+                if (set_.less_(key, v)) {
+                    res = v;
+                    v = v->left;
+                } else {
+                    v = v->right;
+                }
+            }
+            return res ? std::optional<T>(res->value) : std::nullopt;
+        });
+    }
+
+    size_t size() const {
+        return read([&](bool &) { return set_.size(); });
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // Упорядоченный обход под замком писателя.
+    template <typename F>
+    void for_each(F fn) const {
+        std::lock_guard lock(writer_);
+        for (const T &value : set_) {
+            fn(value);
+        }
+    }
+
+private:
+    const Node *find_node(const T &value, bool &ok) const {
+        auto key = Set::probe(value);
+        const Node *v = set_.root_;
+        for (size_t steps = 0; v; ++steps) {
+            if (steps == step_limit) {
+                ok = false;
+                return nullptr;
+            }
+            int c = set_.compare_(key, v);
+            if (c == 0) {
+                return v;
+            }
+            v = c < 0 ? v->left : v->right;
+        }
+        return nullptr;
+    }
+
+    template <typename F>
+    auto read(F f) const {
+        EpochGuard guard(domain_);
+        while (true) {
+            uint64_t before = seq_.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            bool ok = true;
+            auto res = f(ok);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ok && seq_.load(std::memory_order_relaxed) == before) {
+                return res;
+            }
+        }
+    }
+
+    template <typename F>
+    void write(F f) {
+        std::lock_guard lock(writer_);
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        try {
+            f();
+        } catch (...) {
+            seq_.store(seq + 2, std::memory_order_release);
+            throw;
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    mutable EpochDomain domain_;
+    alignas(64) std::atomic<uint64_t> seq_{0};
+    mutable std::mutex writer_;
+    // Объявлено после domain_: деструктор множества освобождает свои узлы
+    // через домен.
+    Set set_;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "avl-set.hpp"
+
+namespace my_algorithms {
+
+// N независимых AvlSet, каждый под своим мьютексом. Ключи делятся по
+// диапазонам: шард i хранит ключи из [bounds[i - 1], bounds[i]), поэтому
+// упорядоченный обход — это обход шардов по очереди.
+template <
+    typename T,
+    std::size_t N,
+    typename Compare = std::less<T>,
+    typename Allocator = std::allocator<T>>
+class ShardedAvlSet {
+    static_assert(N >= 1, "at least one shard is required");
+
+    using Set = AvlSet<T, Compare, Allocator>;
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        // Меняются только под mutex.
+        mutable uint64_t acquisitions = 0;
+        mutable uint64_t contended = 0;
+        Set set;
+    };
+
+    struct Bounds {
+        std::vector<T> keys;
+    };
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+
+    struct ShardStats {
+        uint64_t acquisitions;
+        uint64_t contended;
+        size_t size;
+    };
+
+    static constexpr size_t shard_count = N;
+
+    ShardedAvlSet() : ShardedAvlSet(std::vector<T>()) {
+    }
+
+    // boundaries — до N - 1 строго возрастающих границ шардов.
+    explicit ShardedAvlSet(std::vector<T> boundaries) {
+        bounds_history_.push_back(
+            std::make_unique<const Bounds>(Bounds{std::move(boundaries)})
+        );
+        bounds_.store(bounds_history_.back().get());
+    }
+
+    ShardedAvlSet(const ShardedAvlSet &) = delete;
+    ShardedAvlSet &operator=(const ShardedAvlSet &) = delete;
+
+    bool insert(const T &value) {
+        return with_shard(value, [&value](Set &set) {
+            size_t before = set.size();
+            set.insert(value);
+            return set.size() != before;
+        });
+    }
+
+    bool erase(const T &value) {
+        return with_shard(value, [&value](Set &set) {
+            size_t before = set.size();
+            set.erase(value);
+            return set.size() != before;
+        });
+    }
+
+    bool contains(const T &value) const {
+        return with_shard(value, [&value](const Set &set) {
+            return set.contains(value);
+        });
+    }
+
+    // Наименьший ключ не меньше value; шарды смотрятся по очереди. Все
+    // шарды просматриваются при одних и тех же границах: если под замком
+    // очередного шарда они сменились, поиск начинается заново.
+    std::optional<T> lower_bound(const T &value) const {
+        while (true) {
+            const Bounds *bounds = bounds_.load(std::memory_order_acquire);
+            size_t first = shard_for(*bounds, value);
+            bool stale = false;
+            for (size_t i = first; i < N; ++i) {
+                auto lock = lock_shard(shards_[i]);
+                if (bounds_.load(std::memory_order_acquire) != bounds) {
+                    stale = true;
+                    break;
+                }
+                const Set &set = shards_[i].set;
+                auto it = i == first ? set.lower_bound(value) : set.begin();
+                if (it != set.end()) {
+                    return *it;
+                }
+            }
+            if (!stale) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    size_t size() const {
+        size_t res = 0;
+        for (const Shard &shard : shards_) {
+            auto lock = lock_shard(shard);
+            res += shard.set.size();
+        }
+        return res;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // Упорядоченный обход; каждый шард блокируется на время своего обхода.
+    template <typename F>
+    void for_each(F fn) const {
+        for (const Shard &shard : shards_) {
+            auto lock = lock_shard(shard);
+            for (const T &value : shard.set) {
+                fn(value);
+            }
+        }
+    }
+
+    void clear() {
+        auto locks = lock_all();
+        for (Shard &shard : shards_) {
+            shard.set.clear();
+        }
+    }
+
+    // Пересчитывает границы так, чтобы в шардах было поровну ключей.
+    void rebalance() {
+        auto locks = lock_all();
+        std::vector<T> all = collect();
+        std::vector<T> keys;
+        if (all.size() >= N) {
+            for (size_t i = 1; i < N; ++i) {
+                keys.push_back(all[all.size() * i / N]);
+            }
+        }
+        redistribute(std::move(all), std::move(keys));
+    }
+
+    void set_boundaries(std::vector<T> boundaries) {
+        auto locks = lock_all();
+        redistribute(collect(), std::move(boundaries));
+    }
+
+    std::vector<T> boundaries() const {
+        auto locks = lock_all();
+        return bounds_.load(std::memory_order_acquire)->keys;
+    }
+
+    std::array<ShardStats, N> stats() const {
+        std::array<ShardStats, N> res;
+        for (size_t i = 0; i < N; ++i) {
+            const Shard &shard = shards_[i];
+            std::lock_guard lock(shard.mutex);
+            res[i] = {shard.acquisitions, shard.contended, shard.set.size()};
+        }
+        return res;
+    }
+
+private:
+    size_t shard_for(const Bounds &bounds, const T &value) const {
+        return std::upper_bound(
+                   bounds.keys.begin(), bounds.keys.end(), value, comp_
+               ) -
+               bounds.keys.begin();
+    }
+
+    std::unique_lock<std::mutex> lock_shard(const Shard &shard) const {
+        std::unique_lock lock(shard.mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            lock.lock();
+            ++shard.contended;
+        }
+        ++shard.acquisitions;
+        return lock;
+    }
+
+    // Границы меняются только при всех захваченных шардах, поэтому если
+    // под замком шарда указатель не изменился, шард выбран верно.
+    template <typename F>
+    decltype(auto) with_shard(const T &value, F f) const {
+        while (true) {
+            const Bounds *bounds = bounds_.load(std::memory_order_acquire);
+            const Shard &shard = shards_[shard_for(*bounds, value)];
+            auto lock = lock_shard(shard);
+            if (bounds_.load(std::memory_order_acquire) == bounds) {
+                return f(shard.set);
+            }
+        }
+    }
+
+    template <typename F>
+    decltype(auto) with_shard(const T &value, F f) {
+        return std::as_const(*this).with_shard(value, [&f](const Set &set) {
+            return f(const_cast<Set &>(set));
+        });
+    }
+
+    std::vector<std::unique_lock<std::mutex>> lock_all() const {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for (const Shard &shard : shards_) {
+            locks.push_back(lock_shard(shard));
+        }
+        return locks;
+    }
+
+    std::vector<T> collect() const {
+        std::vector<T> all;
+        for (const Shard &shard : shards_) {
+            all.insert(all.end(), shard.set.begin(), shard.set.end());
+        }
+        return all;
+    }
+
+    void redistribute(std::vector<T> all, std::vector<T> keys) {
+        if (keys.size() > N - 1) {
+            keys.erase(keys.begin() + (N - 1), keys.end());
+        }
+        auto next = std::make_unique<const Bounds>(Bounds{std::move(keys)});
+        auto it = all.begin();
+        for (size_t i = 0; i < N; ++i) {
+            auto last = i < next->keys.size()
+                            ? std::lower_bound(
+                                  it, all.end(), next->keys[i], comp_
+                              )
+                            : all.end();
+            shards_[i].set.clear();
+            shards_[i].set.insert_bulk(it, last, execution::seq);
+            it = last;
+        }
+        bounds_.store(next.get(), std::memory_order_release);
+        // Старые границы могут ещё читаться без замка, поэтому живут до конца.
+        bounds_history_.push_back(std::move(next));
+    }
+
+    std::array<Shard, N> shards_;
+    std::atomic<const Bounds *> bounds_;
+    std::vector<std::unique_ptr<const Bounds>> bounds_history_;
+    Compare comp_;
+};
+
+}  // namespace my_algorithms
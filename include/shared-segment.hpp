@@ -0,0 +1,378 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace my_algorithms {
+
+// Указатель, хранящий смещение цели относительно собственного адреса.
+// Структура из таких указателей остаётся корректной, в каком бы месте
+// адресного пространства ни был отображён содержащий её сегмент. При
+// копировании смещение пересчитывается от адреса копии.
+template <typename T>
+class OffsetPtr {
+public:
+    using element_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    template <typename U>
+    using rebind = OffsetPtr<U>;
+
+    OffsetPtr() noexcept = default;
+
+    OffsetPtr(std::nullptr_t) noexcept {
+    }
+
+    OffsetPtr(T *ptr) noexcept {
+        set(ptr);
+    }
+
+    OffsetPtr(const OffsetPtr &other) noexcept {
+        set(other.get());
+    }
+
+    template <typename U>
+        requires std::convertible_to<U *, T *>
+    OffsetPtr(const OffsetPtr<U> &other) noexcept {
+        set(other.get());
+    }
+
+    OffsetPtr &operator=(const OffsetPtr &other) noexcept {
+        set(other.get());
+        return *this;
+    }
+
+    OffsetPtr &operator=(T *ptr) noexcept {
+        set(ptr);
+        return *this;
+    }
+
+    OffsetPtr &operator=(std::nullptr_t) noexcept {
+        offset_ = null_offset;
+        return *this;
+    }
+
+    T *get() const noexcept {
+        if (offset_ == null_offset) {
+            return nullptr;
+        }
+        return reinterpret_cast<T *>(self() + offset_);
+    }
+
+    operator T *() const noexcept {
+        return get();
+    }
+
+    T *operator->() const noexcept {
+        return get();
+    }
+
+    template <typename U = T>
+        requires(!std::is_void_v<U>)
+    U &operator*() const noexcept {
+        return *get();
+    }
+
+    template <typename U = T>
+        requires(!std::is_void_v<U>)
+    static OffsetPtr pointer_to(U &value) noexcept {
+        return OffsetPtr(std::addressof(value));
+    }
+
+private:
+    // Смещение 0 означает «указывает на себя», поэтому nullptr кодируется
+    // нечётным смещением, которого у выровненного объекта быть не может.
+    static constexpr std::intptr_t null_offset = 1;
+
+    std::intptr_t self() const noexcept {
+        return reinterpret_cast<std::intptr_t>(this);
+    }
+
+    void set(T *ptr) noexcept {
+        offset_ = ptr ? reinterpret_cast<std::intptr_t>(ptr) - self()
+                      : null_offset;
+    }
+
+    std::intptr_t offset_ = null_offset;
+};
+
+namespace detail {
+
+// Лежит в начале сегмента. Свободные блоки одного класса размера связаны
+// в список, ссылка хранится в первых байтах блока смещением от заголовка.
+struct SegmentHeader {
+    static constexpr char signature[8] = {'A', 'V', 'L', 'S', 'H', 'M', 0, 1};
+    static constexpr size_t granule = alignof(std::max_align_t);
+    static constexpr size_t size_classes = 32;
+
+    char magic[8];
+    std::uint64_t capacity;
+    std::uint64_t used;
+    std::uint64_t free[size_classes];
+    OffsetPtr<void> root;
+
+    explicit SegmentHeader(std::uint64_t capacity) noexcept
+        : capacity(capacity), used(aligned(sizeof(SegmentHeader))), free{} {
+        std::memcpy(magic, signature, sizeof(magic));
+    }
+
+    static constexpr size_t aligned(size_t bytes) noexcept {
+        return (bytes + granule - 1) / granule * granule;
+    }
+
+    char *base() noexcept {
+        return reinterpret_cast<char *>(this);
+    }
+
+    void *allocate(size_t bytes) {
+        bytes = aligned(std::max<size_t>(bytes, 1));
+        size_t cls = bytes / granule - 1;
+        if (cls < size_classes && free[cls]) {
+            char *block = base() + free[cls];
+            std::memcpy(&free[cls], block, sizeof(std::uint64_t));
+            return block;
+        }
+        if (bytes > capacity - used) {
+            throw std::bad_alloc();
+        }
+        char *block = base() + used;
+        used += bytes;
+        return block;
+    }
+
+    // Блоки больше последнего класса не переиспользуются.
+    void deallocate(void *ptr, size_t bytes) noexcept {
+        size_t cls = aligned(std::max<size_t>(bytes, 1)) / granule - 1;
+        if (cls >= size_classes) {
+            return;
+        }
+        std::memcpy(ptr, &free[cls], sizeof(std::uint64_t));
+        free[cls] = static_cast<char *>(ptr) - base();
+    }
+};
+
+}  // namespace detail
+
+// Аллокатор из SharedSegment. Сам хранит OffsetPtr на заголовок, поэтому
+// контейнер с таким аллокатором можно целиком разместить в сегменте.
+// Выделение не синхронизировано: пишет в сегмент один процесс.
+template <typename T>
+class SegmentAllocator {
+public:
+    using value_type = T;
+    using pointer = OffsetPtr<T>;
+    using const_pointer = OffsetPtr<const T>;
+    using void_pointer = OffsetPtr<void>;
+    using const_void_pointer = OffsetPtr<const void>;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    SegmentAllocator() noexcept = default;
+
+    explicit SegmentAllocator(detail::SegmentHeader *header) noexcept
+        : header_(header) {
+    }
+
+    template <typename U>
+    SegmentAllocator(const SegmentAllocator<U> &other) noexcept
+        : header_(other.header_) {
+    }
+
+    pointer allocate(size_t n) {
+        detail::SegmentHeader *header = header_;
+        if (!header || n > SIZE_MAX / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return pointer(static_cast<T *>(header->allocate(n * sizeof(T))));
+    }
+
+    void deallocate(pointer p, size_t n) noexcept {
+        header_->deallocate(p.get(), n * sizeof(T));
+    }
+
+    friend bool operator==(
+        const SegmentAllocator &lhs,
+        const SegmentAllocator &rhs
+    ) noexcept {
+        return lhs.header_.get() == rhs.header_.get();
+    }
+
+private:
+    template <typename>
+    friend class SegmentAllocator;
+
+    OffsetPtr<detail::SegmentHeader> header_;
+};
+
+// Файл, отображённый в память с MAP_SHARED. Файл на tmpfs (/dev/shm) даёт
+// обычную разделяемую память. Один процесс создаёт сегмент и строит в нём
+// объект через construct(), остальные открывают его через open() и читают
+// объект по root(). Объекты в сегменте должны быть позиционно-независимыми:
+// ссылки только через OffsetPtr, никакой памяти вне сегмента — например,
+// AvlSet<int, std::less<int>, SegmentAllocator<int>>.
+class SharedSegment {
+public:
+    enum class Mode { ReadOnly, ReadWrite };
+
+    static SharedSegment create(
+        const std::filesystem::path &path,
+        size_t capacity
+    ) {
+        capacity = detail::SegmentHeader::aligned(
+            std::max(capacity, sizeof(detail::SegmentHeader))
+        );
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw_errno("open segment");
+        }
+        if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "ftruncate");
+        }
+        SharedSegment segment(fd, capacity, true);
+        new (segment.base_) detail::SegmentHeader(capacity);
+        return segment;
+    }
+
+    static SharedSegment open(
+        const std::filesystem::path &path,
+        Mode mode = Mode::ReadOnly
+    ) {
+        bool writable = mode == Mode::ReadWrite;
+        int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            throw_errno("open segment");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "fstat");
+        }
+        auto length = static_cast<size_t>(st.st_size);
+        if (length < sizeof(detail::SegmentHeader)) {
+            ::close(fd);
+            throw std::runtime_error("SharedSegment: file is too small");
+        }
+        SharedSegment segment(fd, length, writable);
+        const detail::SegmentHeader *header = segment.header();
+        if (std::memcmp(
+                header->magic, detail::SegmentHeader::signature,
+                sizeof(header->magic)
+            ) != 0 ||
+            header->capacity != length) {
+            throw std::runtime_error("SharedSegment: bad segment header");
+        }
+        return segment;
+    }
+
+    SharedSegment(SharedSegment &&other) noexcept
+        : base_(std::exchange(other.base_, nullptr)),
+          length_(other.length_),
+          writable_(other.writable_) {
+    }
+
+    SharedSegment &operator=(SharedSegment &&other) noexcept {
+        std::swap(base_, other.base_);
+        std::swap(length_, other.length_);
+        std::swap(writable_, other.writable_);
+        return *this;
+    }
+
+    ~SharedSegment() {
+        if (base_) {
+            ::munmap(base_, length_);
+        }
+    }
+
+    template <typename U>
+    SegmentAllocator<U> allocator() const {
+        require_writable();
+        return SegmentAllocator<U>(header());
+    }
+
+    // Создаёт в сегменте корневой объект, по которому его найдут читатели.
+    template <typename Object, typename... Args>
+    Object *construct(Args &&...args) {
+        require_writable();
+        if (header()->root) {
+            throw std::logic_error("SharedSegment: root already exists");
+        }
+        auto allocator = this->allocator<Object>();
+        Object *object = allocator.allocate(1);
+        try {
+            std::construct_at(object, std::forward<Args>(args)...);
+        } catch (...) {
+            allocator.deallocate(object, 1);
+            throw;
+        }
+        header()->root = object;
+        return object;
+    }
+
+    template <typename Object>
+    Object *root() const noexcept {
+        return static_cast<Object *>(header()->root.get());
+    }
+
+    size_t capacity() const noexcept {
+        return length_;
+    }
+
+    size_t used() const noexcept {
+        return header()->used;
+    }
+
+    void *base() const noexcept {
+        return base_;
+    }
+
+private:
+    SharedSegment(int fd, size_t length, bool writable)
+        : length_(length), writable_(writable) {
+        int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+        void *base = ::mmap(nullptr, length, prot, MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            throw std::system_error(err, std::generic_category(), "mmap");
+        }
+        base_ = base;
+    }
+
+    detail::SegmentHeader *header() const noexcept {
+        return static_cast<detail::SegmentHeader *>(base_);
+    }
+
+    void require_writable() const {
+        if (!writable_) {
+            throw std::logic_error("SharedSegment: mapped read-only");
+        }
+    }
+
+    [[noreturn]] static void throw_errno(const char *what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    void *base_ = nullptr;
+    size_t length_ = 0;
+    bool writable_ = false;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define MY_ALGORITHMS_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace my_algorithms::simd {
+
+enum class Isa { Scalar, Sse2, Avx2 };
+
+// Ключи, которые можно сравнивать одной векторной инструкцией:
+// 4- и 8-байтные числа со стандартным std::less.
+template <typename T, typename Compare>
+inline constexpr bool is_searchable_v =
+    std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+    (sizeof(T) == 4 || sizeof(T) == 8) &&
+    (std::is_same_v<Compare, std::less<T>> ||
+     std::is_same_v<Compare, std::less<>>);
+
+namespace detail {
+
+template <typename T>
+std::size_t lower_bound_scalar(const T *keys, std::size_t n, T key) noexcept {
+    // Блок отсортирован, поэтому позиция = количество ключей меньше key.
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        res += keys[i] < key ? 1 : 0;
+    }
+    return res;
+}
+
+#ifdef MY_ALGORITHMS_SIMD_X86
+
+template <typename T>
+std::size_t lower_bound_sse2(const T *keys, std::size_t n, T key) noexcept {
+    std::size_t i = 0;
+    std::size_t res = 0;
+    if constexpr (std::is_same_v<T, float>) {
+        const __m128 k = _mm_set1_ps(key);
+        for (; i + 4 <= n; i += 4) {
+            __m128 lt = _mm_cmplt_ps(_mm_loadu_ps(keys + i), k);
+            res += __builtin_popcount(_mm_movemask_ps(lt));
+        }
+    } else if constexpr (std::is_same_v<T, double>) {
+        const __m128d k = _mm_set1_pd(key);
+        for (; i + 2 <= n; i += 2) {
+            __m128d lt = _mm_cmplt_pd(_mm_loadu_pd(keys + i), k);
+            res += __builtin_popcount(_mm_movemask_pd(lt));
+        }
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) == 4) {
+        // Для беззнаковых сдвигаем в знаковый диапазон.
+        const __m128i bias = _mm_set1_epi32(
+            std::is_signed_v<T> ? 0 : static_cast<int>(0x80000000U)
+        );
+        const __m128i k =
+            _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key)), bias);
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)),
+                bias
+            );
+            __m128i lt = _mm_cmplt_epi32(v, k);
+            res += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(lt)));
+        }
+    }
+    // В SSE2 нет сравнения 64-битных целых, они целиком идут сюда.
+    return res + lower_bound_scalar(keys + i, n - i, key);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) std::size_t
+lower_bound_avx2(const T *keys, std::size_t n, T key) noexcept {
+    std::size_t i = 0;
+    std::size_t res = 0;
+    if constexpr (std::is_same_v<T, float>) {
+        const __m256 k = _mm256_set1_ps(key);
+        for (; i + 8 <= n; i += 8) {
+            __m256 lt = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), k, _CMP_LT_OQ);
+            res += __builtin_popcount(_mm256_movemask_ps(lt));
+        }
+    } else if constexpr (std::is_same_v<T, double>) {
+        const __m256d k = _mm256_set1_pd(key);
+        for (; i + 4 <= n; i += 4) {
+            __m256d lt =
+                _mm256_cmp_pd(_mm256_loadu_pd(keys + i), k, _CMP_LT_OQ);
+            res += __builtin_popcount(_mm256_movemask_pd(lt));
+        }
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) == 4) {
+        const __m256i bias = _mm256_set1_epi32(
+            std::is_signed_v<T> ? 0 : static_cast<int>(0x80000000U)
+        );
+        const __m256i k =
+            _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(key)), bias);
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_xor_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)
+                ),
+                bias
+            );
+            __m256i lt = _mm256_cmpgt_epi32(k, v);
+            res += __builtin_popcount(
+                _mm256_movemask_ps(_mm256_castsi256_ps(lt))
+            );
+        }
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) == 8) {
+        const __m256i bias = _mm256_set1_epi64x(
+            std::is_signed_v<T> ? 0
+                                : static_cast<long long>(0x8000000000000000ULL)
+        );
+        const __m256i k = _mm256_xor_si256(
+            _mm256_set1_epi64x(static_cast<long long>(key)), bias
+        );
+        for (; i + 4 <= n; i += 4) {
+            __m256i v = _mm256_xor_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)
+                ),
+                bias
+            );
+            __m256i lt = _mm256_cmpgt_epi64(k, v);
+            res += __builtin_popcount(
+                _mm256_movemask_pd(_mm256_castsi256_pd(lt))
+            );
+        }
+    }
+    return res + lower_bound_scalar(keys + i, n - i, key);
+}
+
+#endif
+
+inline Isa detect_isa() noexcept {
+#ifdef MY_ALGORITHMS_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return Isa::Sse2;
+    }
+#endif
+    return Isa::Scalar;
+}
+
+}  // namespace detail
+
+inline Isa active_isa() noexcept {
+    static const Isa isa = detail::detect_isa();
+    return isa;
+}
+
+// Индекс первого ключа в отсортированном блоке, не меньшего key.
+template <typename T>
+std::size_t lower_bound(const T *keys, std::size_t n, T key) noexcept {
+    static_assert(is_searchable_v<T, std::less<T>>);
+#ifdef MY_ALGORITHMS_SIMD_X86
+    switch (active_isa()) {
+        case Isa::Avx2:
+            return detail::lower_bound_avx2(keys, n, key);
+        case Isa::Sse2:
+            return detail::lower_bound_sse2(keys, n, key);
+        case Isa::Scalar:
+            break;
+    }
+#endif
+    return detail::lower_bound_scalar(keys, n, key);
+}
+
+// Индекс первого ключа, большего key: key < x  <=>  !(x < key) && x != key.
+template <typename T>
+std::size_t upper_bound(const T *keys, std::size_t n, T key) noexcept {
+    std::size_t i = lower_bound(keys, n, key);
+    while (i < n && !(key < keys[i])) {
+        ++i;
+    }
+    return i;
+}
+
+}  // namespace my_algorithms::simd
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include "avl-set.hpp"
+
+namespace my_algorithms {
+
+// Множество, которое хранит до N элементов в отсортированном массиве внутри
+// объекта и переходит на AvlSet, только когда элементов становится больше.
+template <
+    typename T,
+    std::size_t N = 16,
+    typename Compare = std::less<T>,
+    typename Allocator = std::allocator<T>>
+class SmallAvlSet {
+    static_assert(N >= 4, "inline buffer must hold at least 4 elements");
+
+    using Tree = AvlSet<T, Compare, Allocator>;
+    using TreeIterator = typename Tree::iterator;
+
+    struct iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        iterator() : ptr_(nullptr), it_(), small_(true) {
+        }
+
+        explicit iterator(const T *ptr) : ptr_(ptr), it_(), small_(true) {
+        }
+
+        explicit iterator(TreeIterator it)
+            : ptr_(nullptr), it_(it), small_(false) {
+        }
+
+        reference operator*() const noexcept {
+            return small_ ? *ptr_ : *it_;
+        }
+
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+
+        iterator &operator++() {
+            if (small_) {
+                ++ptr_;
+            } else {
+                ++it_;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        iterator &operator--() {
+            if (small_) {
+                --ptr_;
+            } else {
+                --it_;
+            }
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator tmp = *this;
+            --(*this);
+            return tmp;
+        }
+
+        bool operator==(const iterator &other) const {
+            return ptr_ == other.ptr_ && it_ == other.it_;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+    private:
+        const T *ptr_;
+        TreeIterator it_;
+        bool small_;
+    };
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+
+    using iterator = typename SmallAvlSet::iterator;
+    using const_iterator = typename SmallAvlSet::iterator;
+
+    static constexpr size_t inline_capacity = N;
+
+    SmallAvlSet() {
+    }
+
+    SmallAvlSet(const SmallAvlSet &) = delete;
+    SmallAvlSet &operator=(const SmallAvlSet &) = delete;
+
+    ~SmallAvlSet() {
+        std::destroy_n(data(), small_size_);
+    }
+
+    iterator begin() const {
+        return small_ ? iterator(data()) : iterator(tree_.begin());
+    }
+
+    iterator end() const {
+        return small_ ? iterator(data() + small_size_) : iterator(tree_.end());
+    }
+
+    iterator find(const T &value) const {
+        if (!small_) {
+            return iterator(tree_.find(value));
+        }
+        const T *pos = small_lower_bound(value);
+        if (pos == data() + small_size_ || comp_(value, *pos)) {
+            return end();
+        }
+        return iterator(pos);
+    }
+
+    bool contains(const T &value) const {
+        return find(value) != end();
+    }
+
+    size_t count(const T &value) const {
+        return contains(value) ? 1 : 0;
+    }
+
+    iterator lower_bound(const T &value) const {
+        if (!small_) {
+            return iterator(tree_.lower_bound(value));
+        }
+        return iterator(small_lower_bound(value));
+    }
+
+    iterator upper_bound(const T &value) const {
+        if (!small_) {
+            return iterator(tree_.upper_bound(value));
+        }
+        return iterator(
+            std::upper_bound(data(), data() + small_size_, value, comp_)
+        );
+    }
+
+    std::pair<iterator, iterator> equal_range(const T &value) const {
+        return {lower_bound(value), upper_bound(value)};
+    }
+
+    void insert(const T &value) {
+        if (!small_) {
+            tree_.insert(value);
+            return;
+        }
+        T *pos = data() + (small_lower_bound(value) - data());
+        T *last = data() + small_size_;
+        if (pos != last && !comp_(value, *pos)) {
+            return;
+        }
+        if (small_size_ == N) {
+            to_tree();
+            tree_.insert(value);
+            return;
+        }
+        if (pos == last) {
+            ::new (static_cast<void *>(last)) T(value);
+        } else {
+            ::new (static_cast<void *>(last)) T(std::move(*(last - 1)));
+            std::move_backward(pos, last - 1, last);
+            *pos = value;
+        }
+        ++small_size_;
+    }
+
+    void erase(const T &value) {
+        if (!small_) {
+            tree_.erase(value);
+            // Возвращаемся в буфер с запасом, чтобы не прыгать туда-обратно.
+            if (tree_.size() <= N / 4) {
+                to_small();
+            }
+            return;
+        }
+        T *pos = data() + (small_lower_bound(value) - data());
+        T *last = data() + small_size_;
+        if (pos == last || comp_(value, *pos)) {
+            return;
+        }
+        std::move(pos + 1, last, pos);
+        std::destroy_at(last - 1);
+        --small_size_;
+    }
+
+    size_t size() const noexcept {
+        return small_ ? small_size_ : tree_.size();
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    void clear() {
+        std::destroy_n(data(), small_size_);
+        small_size_ = 0;
+        tree_.clear();
+        small_ = true;
+    }
+
+    bool is_small() const noexcept {
+        return small_;
+    }
+
+    key_compare key_comp() const {
+        return comp_;
+    }
+
+    value_compare value_comp() const {
+        return comp_;
+    }
+
+    friend bool operator==(const SmallAvlSet &lhs, const SmallAvlSet &rhs) {
+        return lhs.size() == rhs.size() &&
+               std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    friend bool operator!=(const SmallAvlSet &lhs, const SmallAvlSet &rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    T *data() noexcept {
+        return std::launder(reinterpret_cast<T *>(storage_));
+    }
+
+    const T *data() const noexcept {
+        return std::launder(reinterpret_cast<const T *>(storage_));
+    }
+
+    const T *small_lower_bound(const T &value) const {
+        return std::lower_bound(data(), data() + small_size_, value, comp_);
+    }
+
+    void to_tree() {
+        for (size_t i = 0; i < small_size_; ++i) {
+            tree_.insert(data()[i]);
+        }
+        std::destroy_n(data(), small_size_);
+        small_size_ = 0;
+        small_ = false;
+    }
+
+    void to_small() {
+        for (const T &value : tree_) {
+            ::new (static_cast<void *>(data() + small_size_)) T(value);
+            ++small_size_;
+        }
+        tree_.clear();
+        small_ = true;
+    }
+
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+    size_t small_size_ = 0;
+    bool small_ = true;
+    Tree tree_;
+    Compare comp_;
+};
+
+}  // namespace my_algorithms
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "avl-set.hpp"
+
+namespace my_algorithms {
+
+// Двухуровневое множество в духе LSM: основная часть ключей лежит в
+// неизменяемом отсортированном массиве (около sizeof(T) на ключ), поверх
+// него — два маленьких AvlSet: added с ключами, которых в массиве нет, и
+// removed с удалёнными ключами массива. Изменения стоят O(log delta) на
+// дереве плюс двоичный поиск по массиву без выделений памяти. compact()
+// сливает всё в новый массив за O(n); с max_delta > 0 это происходит само,
+// когда delta перерастает max_delta от массива. Allocator — для узлов
+// деревьев, массив всегда в std::vector<T>.
+template <
+    typename T,
+    typename Compare = std::less<T>,
+    typename Allocator = std::allocator<T>>
+class TieredAvlSet {
+    using Delta = AvlSet<T, Compare, Allocator>;
+    using DeltaIterator = typename Delta::const_iterator;
+
+    // Меньше этого delta не сливается автоматически.
+    static constexpr size_t min_auto_compact = 1024;
+
+public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+
+    // Упорядоченный обход: слияние массива (без removed) и added.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() = default;
+
+        reference operator*() const noexcept {
+            return *current_;
+        }
+
+        pointer operator->() const noexcept {
+            return current_;
+        }
+
+        const_iterator &operator++() {
+            if (from_base_) {
+                ++pos_;
+            } else {
+                ++added_;
+            }
+            settle();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const noexcept {
+            return current_ == other.current_;
+        }
+
+        bool operator!=(const const_iterator &other) const noexcept {
+            return current_ != other.current_;
+        }
+
+    private:
+        friend class TieredAvlSet;
+
+        const_iterator(
+            const TieredAvlSet *set,
+            size_t pos,
+            DeltaIterator added,
+            DeltaIterator removed
+        )
+            : set_(set), pos_(pos), added_(added), removed_(removed) {
+            settle();
+        }
+
+        // removed_ — первый удалённый ключ не меньше base[pos_]: удалённые
+        // ключи есть в массиве, поэтому они идут в ногу с pos_.
+        void settle() {
+            const std::vector<T> &base = set_->base_;
+            DeltaIterator removed_end = set_->removed_.end();
+            while (pos_ < base.size() && removed_ != removed_end &&
+                   !set_->comp_(base[pos_], *removed_)) {
+                ++pos_;
+                ++removed_;
+            }
+            bool base_left = pos_ < base.size();
+            bool added_left = added_ != set_->added_.end();
+            from_base_ = base_left &&
+                         (!added_left || set_->comp_(base[pos_], *added_));
+            if (from_base_) {
+                current_ = &base[pos_];
+            } else {
+                current_ = added_left ? &*added_ : nullptr;
+            }
+        }
+
+        const TieredAvlSet *set_ = nullptr;
+        size_t pos_ = 0;
+        DeltaIterator added_;
+        DeltaIterator removed_;
+        const T *current_ = nullptr;
+        bool from_base_ = false;
+    };
+
+    using iterator = const_iterator;
+
+    TieredAvlSet() = default;
+
+    // keys — в любом порядке, с повторами.
+    explicit TieredAvlSet(std::vector<T> keys, double max_delta = 0.125)
+        : base_(std::move(keys)) {
+        set_max_delta(max_delta);
+        std::sort(base_.begin(), base_.end(), comp_);
+        base_.erase(
+            std::unique(
+                base_.begin(), base_.end(),
+                [this](const T &a, const T &b) { return !comp_(a, b); }
+            ),
+            base_.end()
+        );
+        base_.shrink_to_fit();
+    }
+
+    TieredAvlSet(const TieredAvlSet &) = delete;
+    TieredAvlSet &operator=(const TieredAvlSet &) = delete;
+
+    bool insert(const T &value) {
+        bool changed;
+        if (in_base(value)) {
+            size_t before = removed_.size();
+            removed_.erase(value);
+            changed = removed_.size() != before;
+        } else {
+            size_t before = added_.size();
+            added_.insert(value);
+            changed = added_.size() != before;
+        }
+        maybe_compact();
+        return changed;
+    }
+
+    bool erase(const T &value) {
+        bool changed;
+        size_t before = added_.size();
+        added_.erase(value);
+        if (added_.size() != before) {
+            changed = true;
+        } else if (in_base(value)) {
+            before = removed_.size();
+            removed_.insert(value);
+            changed = removed_.size() != before;
+        } else {
+            changed = false;
+        }
+        maybe_compact();
+        return changed;
+    }
+
+    bool contains(const T &value) const {
+        if (in_base(value)) {
+            return !removed_.contains(value);
+        }
+        return added_.contains(value);
+    }
+
+    size_t count(const T &value) const {
+        return contains(value) ? 1 : 0;
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0, added_.begin(), removed_.begin());
+    }
+
+    const_iterator end() const {
+        return const_iterator();
+    }
+
+    const_iterator lower_bound(const T &value) const {
+        size_t pos =
+            std::lower_bound(base_.begin(), base_.end(), value, comp_) -
+            base_.begin();
+        return const_iterator(
+            this, pos, added_.lower_bound(value), removed_.lower_bound(value)
+        );
+    }
+
+    const_iterator find(const T &value) const {
+        const_iterator it = lower_bound(value);
+        return it != end() && !comp_(value, *it) ? it : end();
+    }
+
+    size_t size() const {
+        return base_.size() - removed_.size() + added_.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    void clear() {
+        std::vector<T>().swap(base_);
+        added_.clear();
+        removed_.clear();
+    }
+
+    // Сливает delta в новый массив за O(n) одним проходом.
+    void compact() {
+        if (added_.empty() && removed_.empty()) {
+            return;
+        }
+        std::vector<T> merged;
+        merged.reserve(size());
+        for (const T &value : *this) {
+            merged.push_back(value);
+        }
+        base_.swap(merged);
+        added_.clear();
+        removed_.clear();
+    }
+
+    // Доля delta от массива, после которой compact() вызывается сам;
+    // 0 — только вручную.
+    void set_max_delta(double max_delta) {
+        if (!(max_delta >= 0)) {
+            throw std::invalid_argument("TieredAvlSet: bad max_delta");
+        }
+        max_delta_ = max_delta;
+    }
+
+    size_t base_size() const noexcept {
+        return base_.size();
+    }
+
+    // Число ключей в деревьях: добавленные плюс удалённые из массива.
+    size_t delta_size() const {
+        return added_.size() + removed_.size();
+    }
+
+private:
+    bool in_base(const T &value) const {
+        auto it = std::lower_bound(base_.begin(), base_.end(), value, comp_);
+        return it != base_.end() && !comp_(value, *it);
+    }
+
+    void maybe_compact() {
+        size_t delta = delta_size();
+        if (max_delta_ > 0 && delta >= min_auto_compact &&
+            delta > max_delta_ * base_.size()) {
+            compact();
+        }
+    }
+
+    std::vector<T> base_;
+    Delta added_;
+    Delta removed_;
+    Compare comp_;
+    double max_delta_ = 0.125;
+};
+
+}  // namespace my_algorithms
@@ -1,7 +1,11 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "../include/avl-set.hpp"
@@ -44,6 +48,7 @@ bool bounds_equal(IterA it_a, IterA end_a, IterB it_b, IterB end_b) {
 }
 
 using my_algorithms::AvlSet;
+namespace execution = my_algorithms::execution;
 
 TEST_CASE("AvlSet basic operations") {
     AvlSet<int> a;
@@ -171,6 +176,923 @@ TEST_CASE("Check key = std::string with castom compare") {
     CHECK_EQ(aa, bb);
 }
 
+struct CountingThreeWay {
+    size_t *calls;
+
+    std::strong_ordering operator()(
+        const std::string &a,
+        const std::string &b
+    ) const {
+        ++*calls;
+        return a <=> b;
+    }
+};
+
+struct CountingLess {
+    size_t *calls;
+
+    bool operator()(const std::string &a, const std::string &b) const {
+        ++*calls;
+        return a < b;
+    }
+};
+
+TEST_CASE("Check three-way compare (one call per level)") {
+    // Длинный общий префикс: каждое сравнение проходит почти всю строку.
+    const std::string prefix(256, 'x');
+    size_t three_way_calls = 0;
+    size_t less_calls = 0;
+    AvlSet<std::string, CountingThreeWay> a(
+        CountingThreeWay{&three_way_calls}
+    );
+    AvlSet<std::string, CountingLess> b(CountingLess{&less_calls});
+    std::set<std::string> c;
+    for (int i = 0; i < 10'000; ++i) {
+        std::string val = prefix + std::to_string(getRandomNumber() % 20'000);
+        a.insert(val);
+        b.insert(val);
+        c.insert(val);
+    }
+    three_way_calls = 0;
+    less_calls = 0;
+    for (int i = 0; i < 10'000; ++i) {
+        std::string val = prefix + std::to_string(getRandomNumber() % 20'000);
+        CHECK_EQ(a.contains(val), c.count(val) == 1);
+        CHECK_EQ(b.contains(val), c.count(val) == 1);
+    }
+    // На уровень приходится одно сравнение вместо одного-двух (в среднем
+    // около полутора): отношение держится около 2/3, с запасом — 3/4.
+    CHECK(three_way_calls * 4 < less_calls * 3);
+
+    for (int i = 0; i < 5'000; ++i) {
+        std::string val = prefix + std::to_string(getRandomNumber() % 20'000);
+        a.erase(val);
+        c.erase(val);
+    }
+    std::vector<std::string> aa(a.begin(), a.end());
+    std::vector<std::string> cc(c.begin(), c.end());
+    CHECK_EQ(aa, cc);
+    CHECK(bounds_equal(
+        a.lower_bound(prefix + "5"), a.end(), c.lower_bound(prefix + "5"),
+        c.end()
+    ));
+}
+
+TEST_CASE("Check key = std::string with cached key prefix") {
+    // Короткие строки из символов с '\0' и старшим битом, чтобы проверить
+    // упаковку префикса и разрешение ничьих полным сравнением.
+    const char c[] = {'\0', '\x01', 'a', 'b', '\x7f', '\x80', '\xff'};
+    auto random_key = [&c]() {
+        std::string res;
+        int n = getRandomNumber() % 12;
+        for (int i = 0; i < n; ++i) {
+            res += c[getRandomNumber() % sizeof(c)];
+        }
+        return res;
+    };
+    AvlSet<std::string> a;
+    std::set<std::string> b;
+    for (int i = 0; i < 50'000; ++i) {
+        std::string val = random_key();
+        if (i % 3 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        val = random_key();
+        CHECK_EQ(a.contains(val), b.count(val) == 1);
+        CHECK(bounds_equal(
+            a.lower_bound(val), a.end(), b.lower_bound(val), b.end()
+        ));
+        CHECK(bounds_equal(
+            a.upper_bound(val), a.end(), b.upper_bound(val), b.end()
+        ));
+    }
+    std::vector<std::string> aa(a.begin(), a.end());
+    std::vector<std::string> bb(b.begin(), b.end());
+    CHECK_EQ(aa, bb);
+}
+
+TEST_CASE("Check insert_bulk (compare with std::set)") {
+    AvlSet<int> a;
+    std::set<int> b;
+    std::vector<int> batch;
+    for (int i = 0; i < 200'000; ++i) {
+        batch.push_back(getRandomNumber() % 300'000);
+    }
+    a.insert_bulk(batch.begin(), batch.end(), execution::par);
+    b.insert(batch.begin(), batch.end());
+    CHECK_EQ(a.size(), b.size());
+
+    for (int round = 0; round < 3; ++round) {
+        batch.clear();
+        for (int i = 0; i < 50'000; ++i) {
+            batch.push_back(getRandomNumber() % 600'000);
+        }
+        if (round % 2 == 0) {
+            a.insert_bulk(batch.begin(), batch.end());
+        } else {
+            a.insert_bulk(batch.begin(), batch.end(), execution::par);
+        }
+        b.insert(batch.begin(), batch.end());
+        for (int i = 0; i < 10'000; ++i) {
+            int val = getRandomNumber() % 600'000;
+            a.erase(val);
+            b.erase(val);
+        }
+    }
+    CHECK_EQ(a.size(), b.size());
+    std::vector<int> aa(a.begin(), a.end());
+    std::vector<int> bb(b.begin(), b.end());
+    CHECK_EQ(aa, bb);
+    for (int i = 0; i < 10'000; ++i) {
+        int val = getRandomNumber() % 600'000;
+        CHECK(bounds_equal(
+            a.lower_bound(val), a.end(), b.lower_bound(val), b.end()
+        ));
+    }
+}
+
+TEST_CASE("Check parallel_for_each and parallel_reduce") {
+    AvlSet<int> a;
+    std::set<int> b;
+    for (int i = 0; i < 100'000; ++i) {
+        int val = getRandomNumber() % 1'000'000;
+        a.insert(val);
+        b.insert(val);
+    }
+    long long expected = 0;
+    for (int i : b) {
+        expected += i;
+    }
+
+    std::atomic<long long> sum = 0;
+    std::atomic<size_t> calls = 0;
+    a.parallel_for_each(execution::par, [&](const int &value) {
+        sum += value;
+        ++calls;
+    });
+    CHECK_EQ(sum.load(), expected);
+    CHECK_EQ(calls.load(), b.size());
+
+    CHECK_EQ(a.parallel_reduce(execution::par, 0LL, std::plus<>()), expected);
+    // Несимметричная свёртка: куски должны сворачиваться по порядку.
+    auto ordered = a.parallel_reduce(
+        execution::par, std::vector<int>(),
+        [](std::vector<int> lhs, std::vector<int> rhs) {
+            lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+            return lhs;
+        },
+        [](const int &value) { return std::vector<int>{value}; }
+    );
+    CHECK_EQ(ordered, std::vector<int>(b.begin(), b.end()));
+
+    AvlSet<int> empty;
+    CHECK_EQ(empty.parallel_reduce(execution::seq, 7, std::plus<>()), 7);
+}
+
+TEST_CASE("Check serialize and deserialize") {
+    AvlSet<int> a;
+    for (int i = -5000; i < 5000; ++i) {
+        a.insert(i * 3);
+    }
+    std::stringstream buf;
+    a.serialize(buf);
+    // Разности соседних ключей маленькие: около байта на ключ.
+    CHECK(buf.str().size() < 2 * a.size());
+
+    AvlSet<int> b;
+    b.insert(42);
+    b.deserialize(buf);
+    CHECK(a == b);
+    CHECK_EQ(b.size(), 10'000);
+    CHECK_EQ(*b.lower_bound(1), 3);
+    b.insert(1);
+    b.erase(3);
+    CHECK_EQ(*b.lower_bound(0), 0);
+    CHECK_EQ(*++b.lower_bound(0), 1);
+
+    AvlSet<std::string, EvilComparator<std::string>> c;
+    for (int i = 0; i < 1000; ++i) {
+        c.insert(getRandomString());
+    }
+    std::stringstream sbuf;
+    c.serialize(sbuf);
+    AvlSet<std::string, EvilComparator<std::string>> d;
+    d.deserialize(sbuf);
+    CHECK(c == d);
+
+    AvlSet<double> e;
+    e.insert(0.5);
+    e.insert(-1.25);
+    std::stringstream dbuf;
+    e.serialize(dbuf);
+    AvlSet<double> f;
+    f.deserialize(dbuf);
+    CHECK(e == f);
+
+    AvlSet<bool> flags;
+    flags.insert(true);
+    flags.insert(false);
+    std::stringstream bbuf;
+    flags.serialize(bbuf);
+    AvlSet<bool> flags_copy;
+    flags_copy.deserialize(bbuf);
+    CHECK(flags == flags_copy);
+    std::string flag_bytes = bbuf.str();
+    flag_bytes.back() = 2;
+    std::stringstream bad_flag(flag_bytes);
+    CHECK_THROWS_AS(flags_copy.deserialize(bad_flag), std::runtime_error);
+
+    std::stringstream empty;
+    AvlSet<int>().serialize(empty);
+    b.deserialize(empty);
+    CHECK(b.empty());
+
+    std::string bytes = buf.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+    AvlSet<int> g;
+    g.insert(7);
+    CHECK_THROWS_AS(g.deserialize(truncated), std::runtime_error);
+    CHECK_EQ(g.size(), 1);
+    std::stringstream wrong_codec(sbuf.str());
+    CHECK_THROWS_AS(g.deserialize(wrong_codec), std::runtime_error);
+}
+
+TEST_CASE("Check statistics policy") {
+    static_assert(std::is_empty_v<my_algorithms::NullStats>);
+    using CountingSet = AvlSet<
+        int, std::less<int>, std::allocator<int>,
+        my_algorithms::CountingStats>;
+    CountingSet a;
+    for (int i = 0; i < 1000; ++i) {
+        a.insert(i);
+    }
+    const auto &stats = a.stats();
+    CHECK_EQ(stats.allocations(), 1000);
+    // Возрастающие ключи — каждая перебалансировка делает поворот.
+    CHECK_GT(stats.rotations(), 0);
+    CHECK_GE(stats.rotations(), stats.rebalances());
+    CHECK_EQ(stats.descents(), 1000);
+    for (int i = 0; i < 1000; i += 2) {
+        a.erase(i);
+    }
+    CHECK_EQ(stats.deallocations(), 500);
+
+    uint64_t comparisons = stats.comparisons();
+    uint64_t descents = stats.descents();
+    CHECK(a.contains(1));
+    CHECK_EQ(stats.descents(), descents + 1);
+    CHECK_GT(stats.comparisons(), comparisons);
+    // Высота AVL-дерева из 500 узлов не больше 1.44 * log2(502) < 13.
+    for (size_t d = 13; d < my_algorithms::CountingStats::depth_buckets;
+         ++d) {
+        CHECK_EQ(stats.descents(d), 0);
+    }
+
+    std::string prom = stats.to_prometheus("test");
+    CHECK_NE(prom.find("# TYPE test_rotations_total counter\n"), prom.npos);
+    CHECK_NE(
+        prom.find(
+            "test_descent_depth_count " + std::to_string(stats.descents())
+        ),
+        prom.npos
+    );
+    std::string json = stats.to_json();
+    CHECK_EQ(json.find("{\"comparisons\":"), 0);
+    CHECK_NE(json.find("\"deallocations\":500"), json.npos);
+
+    a.clear();
+    CHECK_EQ(stats.deallocations(), 1000);
+}
+
+TEST_CASE("Check compact") {
+    using CountingSet = AvlSet<
+        int, std::less<int>, std::allocator<int>,
+        my_algorithms::CountingStats>;
+    std::mt19937 gen(17);
+    auto in_order_and_contiguous = [](const CountingSet &a) {
+        const char *prev = nullptr;
+        std::ptrdiff_t step = 0;
+        for (const int &value : a) {
+            const char *cur = reinterpret_cast<const char *>(&value);
+            if (prev) {
+                if (step == 0) {
+                    step = cur - prev;
+                }
+                if (step <= 0 || cur - prev != step) {
+                    return false;
+                }
+            }
+            prev = cur;
+        }
+        return true;
+    };
+    {
+        CountingSet a;
+        std::set<int> b;
+        for (int i = 0; i < 20'000; ++i) {
+            int val = gen() % 10'000;
+            if (i % 4 == 0) {
+                a.erase(val);
+                b.erase(val);
+            } else {
+                a.insert(val);
+                b.insert(val);
+            }
+        }
+        CHECK_FALSE(in_order_and_contiguous(a));
+
+        // Прерванное вставкой уплотнение начинается заново.
+        CHECK_FALSE(a.compact(100));
+        a.insert(-1);
+        b.insert(-1);
+        int calls = 1;
+        while (!a.compact(1000)) {
+            ++calls;
+        }
+        CHECK_EQ(calls, (b.size() + 999) / 1000);
+        CHECK(in_order_and_contiguous(a));
+        CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+        // После уплотнения множество работает как обычно, повторное
+        // уплотнение освобождает прошлый блок.
+        for (int i = 0; i < 5000; ++i) {
+            int val = gen() % 10'000;
+            a.erase(val);
+            b.erase(val);
+            val = gen() % 20'000;
+            a.insert(val);
+            b.insert(val);
+        }
+        a.shrink_to_fit();
+        CHECK(in_order_and_contiguous(a));
+        CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+        for (int val : b) {
+            CHECK(a.contains(val));
+        }
+        a.clear();
+        CHECK(a.compact());
+        CHECK_EQ(a.stats().allocations(), a.stats().deallocations());
+    }
+
+    my_algorithms::EpochDomain domain;
+    AvlSet<std::string> c;
+    c.set_epoch_domain(&domain);
+    for (int i = 0; i < 1000; ++i) {
+        c.insert(std::to_string(i));
+    }
+    {
+        auto guard = domain.pin();
+        auto it = c.find("500");
+        c.compact();
+        // Старый узел со своим значением жив, пока читатель в эпохе.
+        CHECK_EQ(*it, "500");
+    }
+    CHECK_EQ(*c.find("500"), "500");
+    CHECK_EQ(c.size(), 1000);
+}
+
+TEST_CASE("Check membership filter") {
+    my_algorithms::CountingBloomFilter filter(10'000, 0.01);
+    for (uint64_t i = 0; i < 10'000; ++i) {
+        filter.add(my_algorithms::CountingBloomFilter::mix(i));
+    }
+    int false_positives = 0;
+    for (uint64_t i = 10'000; i < 110'000; ++i) {
+        false_positives +=
+            filter.may_contain(my_algorithms::CountingBloomFilter::mix(i));
+    }
+    CHECK_LT(false_positives, 2000);
+    for (uint64_t i = 0; i < 10'000; ++i) {
+        filter.remove(my_algorithms::CountingBloomFilter::mix(i));
+    }
+    CHECK_FALSE(filter.may_contain(my_algorithms::CountingBloomFilter::mix(5)));
+
+    AvlSet<int> a;
+    std::set<int> b;
+    a.enable_filter(0.01);
+    size_t capacity = a.filter()->capacity();
+    std::mt19937 gen(23);
+    for (int i = 0; i < 30'000; ++i) {
+        int val = gen() % 20'000;
+        if (i % 3 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        val = gen() % 40'000;
+        CHECK_EQ(a.contains(val), b.count(val) == 1);
+    }
+    // Фильтр перестроился под выросшее множество.
+    CHECK_GT(a.filter()->capacity(), capacity);
+    CHECK_GE(a.filter()->capacity(), a.size());
+
+    std::vector<int> batch(10'000);
+    for (int &val : batch) {
+        val = gen() % 60'000;
+    }
+    a.insert_bulk(batch.begin(), batch.end());
+    b.insert(batch.begin(), batch.end());
+    for (int val = 0; val < 60'000; ++val) {
+        CHECK_EQ(a.find(val) != a.end(), b.count(val) == 1);
+    }
+
+    std::stringstream buf;
+    a.serialize(buf);
+    a.clear();
+    CHECK_FALSE(a.contains(*b.begin()));
+    a.deserialize(buf);
+    for (int val : b) {
+        CHECK(a.contains(val));
+    }
+    a.disable_filter();
+    CHECK_EQ(a.filter(), nullptr);
+    CHECK(a.contains(*b.begin()));
+}
+
+TEST_CASE("Check hash index") {
+    AvlSet<std::string> a;
+    std::set<std::string> b;
+    for (int i = 0; i < 500; ++i) {
+        a.insert(std::to_string(i));
+        b.insert(std::to_string(i));
+    }
+    a.enable_hash_index();
+    REQUIRE(a.hash_index() != nullptr);
+    CHECK_EQ(a.hash_index()->size(), 500);
+    std::mt19937 gen(29);
+    for (int i = 0; i < 40'000; ++i) {
+        std::string val = std::to_string(gen() % 5000);
+        if (i % 3 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        val = std::to_string(gen() % 6000);
+        auto it = a.find(val);
+        CHECK_EQ(it != a.end(), b.count(val) == 1);
+        if (it != a.end()) {
+            CHECK_EQ(*it, val);
+            // Итератор из индекса — обычный итератор дерева.
+            auto next = std::next(it);
+            auto expected = std::next(b.find(val));
+            CHECK_EQ(next == a.end(), expected == b.end());
+        }
+    }
+    CHECK_EQ(a.hash_index()->size(), b.size());
+
+    std::vector<std::string> batch;
+    for (int i = 0; i < 3000; ++i) {
+        batch.push_back("bulk" + std::to_string(gen() % 2000));
+    }
+    a.insert_bulk(batch.begin(), batch.end());
+    b.insert(batch.begin(), batch.end());
+    a.compact();
+    CHECK_EQ(a.hash_index()->size(), b.size());
+    for (const auto &val : b) {
+        auto it = a.find(val);
+        REQUIRE(it != a.end());
+        CHECK_EQ(*it, val);
+    }
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    std::stringstream buf;
+    a.serialize(buf);
+    a.clear();
+    CHECK_EQ(a.hash_index()->size(), 0);
+    CHECK_FALSE(a.contains(*b.begin()));
+    a.deserialize(buf);
+    CHECK_EQ(a.hash_index()->size(), b.size());
+    CHECK(a.contains(*b.rbegin()));
+    a.disable_hash_index();
+    CHECK(a.contains(*b.rbegin()));
+}
+
+TEST_CASE("Check buffered insert") {
+    using CountedSet = AvlSet<
+        int, std::less<int>, std::allocator<int>,
+        my_algorithms::CountingStats>;
+    CountedSet a;
+    std::set<int> b;
+    a.enable_buffered_insert(50'000);
+    std::mt19937 gen(47);
+    for (int i = 0; i < 30'000; ++i) {
+        int val = gen() % 100'000;
+        a.insert(val);
+        b.insert(val);
+    }
+    // Пока никто не читал, дерево не тронуто.
+    CHECK_EQ(a.pending(), 30'000);
+    CHECK_EQ(a.stats().allocations(), 0);
+    CHECK_EQ(a.stats().comparisons(), 0);
+    CHECK_EQ(a.size(), b.size());
+    CHECK_EQ(a.pending(), 0);
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    // Каждое чтение видит все вставки до него.
+    for (int i = 0; i < 20'000; ++i) {
+        int val = gen() % 100'000;
+        if (i % 5 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        if (i % 100 == 0) {
+            val = gen() % 100'000;
+            CHECK_EQ(a.contains(val), b.count(val) == 1);
+            auto lb = a.lower_bound(val);
+            auto it = b.lower_bound(val);
+            REQUIRE_EQ(lb == a.end(), it == b.end());
+            if (it != b.end()) {
+                CHECK_EQ(*lb, *it);
+            }
+        }
+    }
+    a.insert(-1);
+    b.insert(-1);
+    CHECK_EQ(*a.begin(), -1);
+    a.insert(1'000'000);
+    b.insert(1'000'000);
+    CHECK_EQ(*a.rbegin(), 1'000'000);
+
+    // Порог буфера.
+    CountedSet c;
+    c.enable_buffered_insert(1000);
+    for (int i = 0; i < 2500; ++i) {
+        c.insert(i);
+    }
+    CHECK_EQ(c.pending(), 500);
+    std::vector<int> batch = {5000, 5001, 1};
+    c.insert_bulk(batch.begin(), batch.end());
+    CHECK_EQ(c.pending(), 0);
+    c.insert(7000);
+    c.flush();
+    CHECK_EQ(c.pending(), 0);
+    CHECK_EQ(c.size(), 2503);
+    c.insert(8000);
+    c.disable_buffered_insert();
+    CHECK_EQ(c.pending(), 0);
+    c.insert(9000);
+    CHECK_EQ(c.pending(), 0);
+    CHECK(c.contains(8000));
+    CHECK(c.contains(9000));
+    CHECK_THROWS_AS(c.enable_buffered_insert(0), std::invalid_argument);
+
+    std::stringstream buf;
+    a.insert(-2);
+    b.insert(-2);
+    a.serialize(buf);
+    a.insert(-3);
+    a.deserialize(buf);
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    // Ключ без конструктора по умолчанию.
+    struct Key {
+        explicit Key(int value) : value(value) {
+        }
+
+        auto operator<=>(const Key &) const = default;
+
+        int value;
+    };
+
+    AvlSet<Key> d;
+    d.enable_buffered_insert(100);
+    for (int i = 0; i < 250; ++i) {
+        d.insert(Key(i % 150));
+    }
+    d.insert(Key(7));
+    CHECK_EQ(d.size(), 150);
+    CHECK(d.contains(Key(149)));
+    CHECK_EQ(d.begin()->value, 0);
+}
+
+TEST_CASE("Check WAVL balance") {
+    using my_algorithms::CountingStats;
+    using AvlTree =
+        AvlSet<int, std::less<int>, std::allocator<int>, CountingStats>;
+    using WavlTree = AvlSet<
+        int, std::less<int>, std::allocator<int>, CountingStats,
+        my_algorithms::WavlBalance>;
+
+    // Без удалений WAVL балансирует ровно как AVL.
+    AvlTree avl;
+    WavlTree wavl;
+    std::mt19937 gen(43);
+    for (int i = 0; i < 50'000; ++i) {
+        int val = gen() % 1'000'000;
+        avl.insert(val);
+        wavl.insert(val);
+    }
+    CHECK_EQ(wavl.stats().rotations(), avl.stats().rotations());
+    CHECK_EQ(wavl.stats().depth_sum(), avl.stats().depth_sum());
+
+    std::set<int> b(avl.begin(), avl.end());
+    for (int i = 0; i < 200'000; ++i) {
+        int val = gen() % 1'000'000;
+        if (i % 2 == 0) {
+            avl.erase(val);
+            wavl.erase(val);
+            b.erase(val);
+        } else {
+            avl.insert(val);
+            wavl.insert(val);
+            b.insert(val);
+        }
+        if (i % 1000 == 0) {
+            val = gen() % 1'000'000;
+            CHECK_EQ(wavl.contains(val), b.count(val) == 1);
+        }
+    }
+    CHECK_EQ(wavl.size(), b.size());
+    CHECK(std::equal(wavl.begin(), wavl.end(), b.begin(), b.end()));
+    CHECK_LT(wavl.stats().rotations(), avl.stats().rotations());
+    // Высота WAVL-дерева не больше 2 log n.
+    for (size_t d = 2 * 17 + 1; d < CountingStats::depth_buckets; ++d) {
+        CHECK_EQ(wavl.stats().descents(d), 0);
+    }
+
+    // Удаление подряд идущих ключей: AVL поворачивает на многих уровнях.
+    uint64_t avl_before = avl.stats().rotations();
+    uint64_t wavl_before = wavl.stats().rotations();
+    for (int val : b) {
+        if (val % 3 != 0) {
+            avl.erase(val);
+            wavl.erase(val);
+        }
+    }
+    MESSAGE(
+        "rotations on erase: AVL " << avl.stats().rotations() - avl_before
+                                   << ", WAVL "
+                                   << wavl.stats().rotations() - wavl_before
+    );
+    CHECK_LT(
+        wavl.stats().rotations() - wavl_before,
+        avl.stats().rotations() - avl_before
+    );
+    CHECK(std::equal(wavl.begin(), wavl.end(), avl.begin(), avl.end()));
+
+    std::vector<int> batch(10'000);
+    for (int &val : batch) {
+        val = gen() % 1'000'000;
+    }
+    wavl.insert_bulk(batch.begin(), batch.end());
+    avl.insert_bulk(batch.begin(), batch.end());
+    CHECK(std::equal(wavl.begin(), wavl.end(), avl.begin(), avl.end()));
+}
+
+TEST_CASE("Check lazy erase") {
+    AvlSet<int> a;
+    std::set<int> b;
+    a.enable_lazy_erase(0.3);
+    a.enable_filter();
+    std::mt19937 gen(41);
+    for (int i = 0; i < 60'000; ++i) {
+        int val = gen() % 5000;
+        if (i % 2 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        CHECK_LE(a.tombstones(), 0.3 * (a.size() + a.tombstones()) + 1);
+        if (i % 1000 == 0) {
+            REQUIRE_EQ(a.size(), b.size());
+            CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+            CHECK(std::equal(a.rbegin(), a.rend(), b.rbegin(), b.rend()));
+            val = gen() % 5000;
+            CHECK_EQ(a.contains(val), b.count(val) == 1);
+            auto lb = a.lower_bound(val);
+            auto it = b.lower_bound(val);
+            REQUIRE_EQ(lb == a.end(), it == b.end());
+            if (it != b.end()) {
+                CHECK_EQ(*lb, *it);
+            }
+            long long sum = a.parallel_reduce(
+                execution::seq, 0LL, std::plus<>(),
+                [](int x) { return (long long)x; }
+            );
+            CHECK_EQ(sum, std::accumulate(b.begin(), b.end(), 0LL));
+        }
+    }
+
+    // Пачка вставок оживляет ключи под надгробиями.
+    std::vector<int> batch(3000);
+    for (int &val : batch) {
+        val = gen() % 6000;
+    }
+    a.insert_bulk(batch.begin(), batch.end());
+    b.insert(batch.begin(), batch.end());
+    CHECK_EQ(a.size(), b.size());
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    a.compact();
+    CHECK_EQ(a.tombstones(), 0);
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+    a.erase(*b.begin());
+    b.erase(b.begin());
+    a.disable_lazy_erase();
+    CHECK_EQ(a.tombstones(), 0);
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    // Пачка удалений без поворотов: все ключи по очереди.
+    using CountedSet = AvlSet<
+        int, std::less<int>, std::allocator<int>,
+        my_algorithms::CountingStats>;
+    CountedSet eager;
+    CountedSet lazy;
+    lazy.enable_lazy_erase(0.5);
+    for (int i = 0; i < 10'000; ++i) {
+        eager.insert(i);
+        lazy.insert(i);
+    }
+    uint64_t eager_before = eager.stats().rotations();
+    uint64_t lazy_before = lazy.stats().rotations();
+    for (int i = 0; i < 10'000; i += 2) {
+        eager.erase(i);
+        lazy.erase(i);
+    }
+    CHECK_EQ(lazy.size(), 5000);
+    CHECK_EQ(lazy.stats().rotations(), lazy_before);
+    CHECK_GT(eager.stats().rotations(), eager_before);
+    CHECK(std::equal(eager.begin(), eager.end(), lazy.begin(), lazy.end()));
+    CHECK_THROWS_AS(lazy.enable_lazy_erase(1.5), std::invalid_argument);
+
+    // Хеш-индекс и кеш горячих ключей не видят надгробий.
+    AvlSet<std::string> c;
+    std::set<std::string> d;
+    c.enable_lazy_erase(0.2);
+    c.enable_hash_index();
+    c.enable_hot_cache(64);
+    for (int i = 0; i < 20'000; ++i) {
+        std::string val = std::to_string(gen() % 500);
+        if (i % 2 == 0) {
+            c.erase(val);
+            d.erase(val);
+        } else {
+            c.insert(val);
+            d.insert(val);
+        }
+        val = std::to_string(gen() % 500);
+        REQUIRE_EQ(c.contains(val), d.count(val) == 1);
+    }
+    CHECK_EQ(c.hash_index()->size(), d.size());
+    c.disable_hash_index();
+    for (int i = 0; i < 500; ++i) {
+        std::string val = std::to_string(i);
+        REQUIRE_EQ(c.contains(val), d.count(val) == 1);
+    }
+}
+
+TEST_CASE("Check hot key cache") {
+    using CountedSet = AvlSet<
+        std::string, std::less<std::string>, std::allocator<std::string>,
+        my_algorithms::CountingStats>;
+    const int n = 20'000;
+    std::mt19937 gen(37);
+    // Ключ ранга r (с нуля) запрашивается с вероятностью ~ 1 / (r + 1)^s.
+    auto zipf = [&](double skew) {
+        std::vector<double> cdf(n);
+        double sum = 0;
+        for (int r = 0; r < n; ++r) {
+            cdf[r] = sum += std::pow(r + 1, -skew);
+        }
+        std::vector<std::string> keys(100'000);
+        std::uniform_real_distribution<double> dist(0, sum);
+        for (auto &key : keys) {
+            auto r = std::upper_bound(cdf.begin(), cdf.end(), dist(gen)) -
+                     cdf.begin();
+            key = std::to_string(r * 7919 % n);
+        }
+        return keys;
+    };
+    for (double skew : {0.5, 0.99, 1.2}) {
+        CountedSet plain;
+        CountedSet cached;
+        for (int i = 0; i < n; ++i) {
+            plain.insert(std::to_string(i));
+            cached.insert(std::to_string(i));
+        }
+        cached.enable_hot_cache(256);
+        auto keys = zipf(skew);
+        uint64_t plain_before = plain.stats().comparisons();
+        uint64_t cached_before = cached.stats().comparisons();
+        for (const auto &key : keys) {
+            REQUIRE(cached.contains(key));
+            plain.contains(key);
+        }
+        uint64_t plain_cost = plain.stats().comparisons() - plain_before;
+        uint64_t cached_cost = cached.stats().comparisons() - cached_before;
+        MESSAGE(
+            "skew " << skew << ": " << cached_cost << " comparisons with "
+                    << "cache vs " << plain_cost << " without"
+        );
+        CHECK_LT(cached_cost, plain_cost);
+        if (skew > 1) {
+            CHECK_LT(2 * cached_cost, plain_cost);
+        }
+    }
+
+    // Удаление узла, в том числе с двумя детьми, и compact() не оставляют
+    // в кеше висячих указателей.
+    AvlSet<std::string> a;
+    std::set<std::string> b;
+    a.enable_hot_cache(64);
+    for (int i = 0; i < 60'000; ++i) {
+        std::string val = std::to_string(gen() % 2000);
+        if (i % 3 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        val = std::to_string(gen() % 300);
+        auto it = a.find(val);
+        REQUIRE_EQ(it != a.end(), b.count(val) == 1);
+        if (it != a.end()) {
+            CHECK_EQ(*it, val);
+        }
+        if (i % 10'000 == 0) {
+            a.compact();
+        }
+    }
+    a.clear();
+    CHECK_FALSE(a.contains("1"));
+    a.insert("1");
+    CHECK(a.contains("1"));
+    a.disable_hot_cache();
+    CHECK(a.contains("1"));
+}
+
+TEST_CASE("Check finger search") {
+    AvlSet<int> a;
+    std::set<int> b;
+    std::mt19937 gen(31);
+    for (int i = 0; i < 20'000; ++i) {
+        int val = gen() % 100'000;
+        a.insert(val);
+        b.insert(val);
+    }
+    std::vector<int> keys(b.begin(), b.end());
+    for (int i = 0; i < 20'000; ++i) {
+        auto hint = a.begin();
+        if (i % 10 != 0) {
+            hint = a.find(keys[gen() % keys.size()]);
+        } else if (i % 20 == 0) {
+            hint = a.end();
+        }
+        int val = gen() % 101'000;
+        auto it = a.lower_bound(hint, val);
+        auto expected = b.lower_bound(val);
+        REQUIRE_EQ(it == a.end(), expected == b.end());
+        if (it != a.end()) {
+            CHECK_EQ(*it, *expected);
+        }
+        CHECK_EQ(a.find(hint, val) != a.end(), b.count(val) == 1);
+    }
+
+    // Слияние с отсортированным потоком: каждый seek — O(1) сравнений в
+    // среднем, а не O(log n).
+    AvlSet<int, std::less<int>, std::allocator<int>,
+           my_algorithms::CountingStats>
+        c;
+    for (int i = 0; i < 100'000; ++i) {
+        c.insert(2 * i);
+    }
+    uint64_t before = c.stats().comparisons();
+    auto cursor = c.cursor();
+    size_t found = 0;
+    for (int key = 0; key < 200'000; key += 3) {
+        cursor.seek(key);
+        REQUIRE_FALSE(cursor.at_end());
+        CHECK_EQ(*cursor, key % 2 == 0 ? key : key + 1);
+        found += *cursor == key;
+    }
+    CHECK_EQ(found, 33'334);
+    CHECK_LT(c.stats().comparisons() - before, 8 * 66'667);
+    cursor.seek(200'000);
+    CHECK(cursor.at_end());
+    cursor.seek(7);
+    CHECK_EQ(*cursor, 8);
+    ++cursor;
+    CHECK_EQ(*cursor.position(), 10);
+
+    AvlSet<int> empty;
+    CHECK(empty.lower_bound(empty.end(), 1) == empty.end());
+    CHECK(empty.cursor().at_end());
+}
+
 TEST_CASE("Check contains (compare with std::set)") {
     AvlSet<int> a;
     std::set<int> b;
@@ -360,3 +1282,32 @@ TEST_CASE("Check reverse iterators rbegin and rend") {
     }
     CHECK(expected == -1);
 }
+
+TEST_CASE("Check optional modes keep the set small and follow swap") {
+    // Корень, компаратор с аллокатором, домен и указатель на состояние
+    // режимов: фильтр, индекс, кеш, надгробия и буфер живут за ним.
+    CHECK_LE(sizeof(AvlSet<int>), 4 * sizeof(void *));
+
+    AvlSet<int> a, b;
+    a.enable_buffered_insert(1000);
+    a.enable_lazy_erase();
+    a.enable_filter();
+    for (int i = 0; i < 100; ++i) {
+        a.insert(i);
+    }
+    CHECK_EQ(a.pending(), 100);
+    a.erase(5);
+    CHECK_EQ(a.tombstones(), 1);
+    a.insert(200);
+
+    a.swap(b);
+    CHECK_EQ(a.pending(), 0);
+    CHECK_EQ(a.tombstones(), 0);
+    CHECK(a.filter() == nullptr);
+    CHECK(a.empty());
+    CHECK_EQ(b.pending(), 1);
+    CHECK_EQ(b.size(), 100);
+    CHECK(b.contains(200));
+    CHECK_FALSE(b.contains(5));
+    CHECK(b.filter() != nullptr);
+}
@@ -0,0 +1,98 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../include/block-avl-set.hpp"
+#include "doctest.h"
+
+int getRandomNumber() {
+    static std::mt19937 gen(7);
+    std::uniform_int_distribution<> dist(0, 1e9);
+    return dist(gen);
+}
+
+template <typename IterA, typename IterB>
+bool bounds_equal(IterA it_a, IterA end_a, IterB it_b, IterB end_b) {
+    if (it_a == end_a && it_b == end_b) {
+        return true;
+    }
+    if (it_a == end_a || it_b == end_b) {
+        return false;
+    }
+    return *it_a == *it_b;
+}
+
+using my_algorithms::BlockAvlSet;
+
+TEST_CASE("BlockAvlSet random operations (compare with std::set)") {
+    BlockAvlSet<int> a;
+    std::set<int> b;
+    for (int i = 0; i < 200'000; ++i) {
+        int val = getRandomNumber() % 50'000;
+        if (getRandomNumber() % 3 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        val = getRandomNumber() % 60'000;
+        CHECK(bounds_equal(
+            a.lower_bound(val), a.end(), b.lower_bound(val), b.end()
+        ));
+        CHECK(bounds_equal(
+            a.upper_bound(val), a.end(), b.upper_bound(val), b.end()
+        ));
+        CHECK_EQ(a.contains(val), b.count(val) == 1);
+    }
+    CHECK_EQ(a.size(), b.size());
+
+    std::vector<int> aa(a.begin(), a.end());
+    std::vector<int> bb(b.begin(), b.end());
+    CHECK_EQ(aa, bb);
+
+    std::vector<int> ra(a.rbegin(), a.rend());
+    std::vector<int> rb(b.rbegin(), b.rend());
+    CHECK_EQ(ra, rb);
+}
+
+TEST_CASE("BlockAvlSet splits and merges blocks") {
+    BlockAvlSet<int, 8> a;
+    for (int i = 0; i < 1000; ++i) {
+        a.insert(i);
+    }
+    CHECK_EQ(a.size(), 1000);
+    for (int i = 0; i < 1000; i += 2) {
+        a.erase(i);
+    }
+    CHECK_EQ(a.size(), 500);
+    int expected = 1;
+    for (int x : a) {
+        CHECK_EQ(x, expected);
+        expected += 2;
+    }
+    for (int i = 1; i < 1000; i += 2) {
+        a.erase(i);
+    }
+    CHECK(a.empty());
+    CHECK_EQ(a.begin(), a.end());
+}
+
+TEST_CASE("BlockAvlSet with std::string keys") {
+    BlockAvlSet<std::string> a;
+    std::set<std::string> b;
+    for (int i = 0; i < 20'000; ++i) {
+        std::string val = std::to_string(getRandomNumber() % 5000);
+        if (i % 4 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+    }
+    std::vector<std::string> aa(a.begin(), a.end());
+    std::vector<std::string> bb(b.begin(), b.end());
+    CHECK_EQ(aa, bb);
+}
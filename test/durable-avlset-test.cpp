@@ -0,0 +1,224 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <sys/resource.h>
+#include <unistd.h>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "../include/durable-avl-set.hpp"
+#include "doctest.h"
+
+using my_algorithms::DurableAvlSet;
+
+namespace {
+
+struct TempDir {
+    std::filesystem::path path;
+
+    explicit TempDir(const std::string &name)
+        : path(
+              std::filesystem::temp_directory_path() /
+              (name + "-" + std::to_string(::getpid()))
+          ) {
+        std::filesystem::remove_all(path);
+    }
+
+    ~TempDir() {
+        std::filesystem::remove_all(path);
+    }
+};
+
+// Ограничивает размер файлов процесса: запись за пределом пишет часть
+// буфера, а следующая падает с EFBIG — так журнал получает отказ диска.
+struct FileSizeLimit {
+    rlimit saved;
+
+    explicit FileSizeLimit(rlim_t bytes) {
+        ::getrlimit(RLIMIT_FSIZE, &saved);
+        std::signal(SIGXFSZ, SIG_IGN);
+        rlimit limit = {bytes, saved.rlim_max};
+        ::setrlimit(RLIMIT_FSIZE, &limit);
+    }
+
+    ~FileSizeLimit() {
+        ::setrlimit(RLIMIT_FSIZE, &saved);
+        std::signal(SIGXFSZ, SIG_DFL);
+    }
+};
+
+template <typename T>
+std::vector<T> contents(const DurableAvlSet<T> &a) {
+    std::vector<T> res;
+    a.for_each([&res](const T &value) { res.push_back(value); });
+    return res;
+}
+
+}  // namespace
+
+TEST_CASE("DurableAvlSet recovers from the log (compare with std::set)") {
+    TempDir dir("durable-avlset-log");
+    std::set<int> b;
+    std::mt19937 gen(7);
+    {
+        DurableAvlSet<int> a(dir.path);
+        for (int i = 0; i < 3000; ++i) {
+            int val = gen() % 1000 - 500;
+            bool changed = i % 3 == 0 ? a.erase(val) : a.insert(val);
+            bool expected =
+                i % 3 == 0 ? b.erase(val) == 1 : b.insert(val).second;
+            CHECK_EQ(changed, expected);
+        }
+        CHECK_EQ(a.stats().checkpoints, 0);
+    }
+    DurableAvlSet<int> a(dir.path);
+    CHECK_EQ(contents(a), std::vector<int>(b.begin(), b.end()));
+    CHECK_GT(a.stats().recovered_records, 0);
+}
+
+TEST_CASE("DurableAvlSet checkpoints and replays the tail") {
+    TempDir dir("durable-avlset-checkpoint");
+    std::set<std::string> b;
+    DurableAvlSet<std::string>::Options options;
+    options.checkpoint_every = 300;
+    {
+        DurableAvlSet<std::string> a(dir.path, options);
+        for (int i = 0; i < 1700; ++i) {
+            std::string key = "key-" + std::to_string(i * 7 % 1300);
+            if (i % 4 == 0) {
+                a.erase(key);
+                b.erase(key);
+            } else {
+                a.insert(key);
+                b.insert(key);
+            }
+        }
+        CHECK_GE(a.stats().checkpoints, 2);
+    }
+    {
+        DurableAvlSet<std::string> a(dir.path, options);
+        // В журнале только записи после последнего снимка.
+        CHECK_LT(a.stats().recovered_records, 300);
+        CHECK_EQ(
+            contents(a), std::vector<std::string>(b.begin(), b.end())
+        );
+        a.insert("tail");
+        b.insert("tail");
+        a.checkpoint();
+    }
+    DurableAvlSet<std::string> a(dir.path, options);
+    CHECK_EQ(a.stats().recovered_records, 0);
+    CHECK_EQ(contents(a), std::vector<std::string>(b.begin(), b.end()));
+}
+
+TEST_CASE("DurableAvlSet ignores a torn record at the end of the log") {
+    TempDir dir("durable-avlset-torn");
+    {
+        DurableAvlSet<int> a(dir.path);
+        for (int i = 0; i < 100; ++i) {
+            a.insert(i);
+        }
+    }
+    {
+        std::ofstream wal(dir.path / "wal", std::ios::binary | std::ios::app);
+        wal.put('I');
+        wal.put('\x05');
+        wal.put('\x01');
+    }
+    {
+        DurableAvlSet<int> a(dir.path);
+        CHECK_EQ(a.size(), 100);
+        a.insert(1000);
+    }
+    DurableAvlSet<int> a(dir.path);
+    CHECK_EQ(a.size(), 101);
+    CHECK(a.contains(1000));
+}
+
+TEST_CASE("DurableAvlSet group commit with concurrent writers") {
+    TempDir dir("durable-avlset-group");
+    {
+        DurableAvlSet<int> a(dir.path);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&a, t] {
+                for (int i = 0; i < 200; ++i) {
+                    a.insert(t * 1000 + i);
+                }
+            });
+        }
+        for (auto &w : writers) {
+            w.join();
+        }
+        auto stats = a.stats();
+        CHECK_EQ(stats.records, 800);
+        CHECK_LE(stats.syncs, stats.records);
+    }
+    DurableAvlSet<int> a(dir.path);
+    CHECK_EQ(a.size(), 800);
+    for (int t = 0; t < 4; ++t) {
+        CHECK(a.contains(t * 1000 + 199));
+    }
+}
+
+TEST_CASE("DurableAvlSet fails all writers after a log write error") {
+    TempDir dir("durable-avlset-fail");
+    auto wal = dir.path / "wal";
+    std::set<int> acked;
+    {
+        DurableAvlSet<int> a(dir.path);
+        for (int i = 0; i < 100; ++i) {
+            a.insert(i);
+            acked.insert(i);
+        }
+        std::mutex mutex;
+        int failures = 0;
+        {
+            FileSizeLimit limit(std::filesystem::file_size(wal) + 100);
+            std::vector<std::thread> writers;
+            for (int t = 0; t < 4; ++t) {
+                writers.emplace_back([&, t] {
+                    for (int i = 0; i < 100; ++i) {
+                        int val = 1000 * (t + 1) + i;
+                        try {
+                            a.insert(val);
+                            std::lock_guard lock(mutex);
+                            acked.insert(val);
+                        } catch (const std::system_error &) {
+                            std::lock_guard lock(mutex);
+                            ++failures;
+                        }
+                    }
+                });
+            }
+            for (auto &w : writers) {
+                w.join();
+            }
+        }
+        CHECK_GT(failures, 0);
+        CHECK_LT(acked.size(), 500);
+        // Журнал остаётся в отказе, в памяти — только сохранённое.
+        CHECK_THROWS_AS(a.insert(-1), std::system_error);
+        CHECK_THROWS_AS(a.erase(1), std::system_error);
+        CHECK_THROWS_AS(a.checkpoint(), std::system_error);
+        CHECK_FALSE(a.contains(-1));
+        CHECK_EQ(contents(a), std::vector<int>(acked.begin(), acked.end()));
+    }
+    // Недописанная запись убрана из журнала при отказе.
+    auto size = std::filesystem::file_size(wal);
+    {
+        DurableAvlSet<int> a(dir.path);
+        CHECK_EQ(std::filesystem::file_size(wal), size);
+        CHECK_EQ(a.stats().recovered_records, acked.size());
+        CHECK_EQ(contents(a), std::vector<int>(acked.begin(), acked.end()));
+        a.insert(-1);
+        acked.insert(-1);
+    }
+    DurableAvlSet<int> a(dir.path);
+    CHECK_EQ(contents(a), std::vector<int>(acked.begin(), acked.end()));
+}
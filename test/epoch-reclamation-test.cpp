@@ -0,0 +1,202 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <atomic>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "../include/epoch-reclamation.hpp"
+#include "doctest.h"
+
+using my_algorithms::AvlSet;
+using my_algorithms::EpochDomain;
+
+namespace {
+
+int freed = 0;
+
+void count_free(void *, void *ptr) {
+    ++freed;
+    delete static_cast<int *>(ptr);
+}
+
+struct Tracked {
+    static inline int alive = 0;
+    int value;
+
+    Tracked(int v) : value(v) {
+        ++alive;
+    }
+
+    Tracked(const Tracked &other) : value(other.value) {
+        ++alive;
+    }
+
+    ~Tracked() {
+        --alive;
+    }
+
+    bool operator<(const Tracked &other) const {
+        return value < other.value;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("EpochDomain frees retired objects only after readers leave") {
+    freed = 0;
+    EpochDomain domain;
+    {
+        auto guard = domain.pin();
+        domain.retire(new int(1), count_free, nullptr);
+        for (int i = 0; i < 10; ++i) {
+            domain.collect();
+        }
+        CHECK_EQ(freed, 0);
+        CHECK_EQ(domain.pending(), 1);
+    }
+    domain.collect();
+    domain.collect();
+    CHECK_EQ(freed, 1);
+    CHECK_EQ(domain.pending(), 0);
+
+    domain.retire(new int(2), count_free, nullptr);
+    domain.drain();
+    CHECK_EQ(freed, 2);
+}
+
+TEST_CASE("AvlSet with EpochDomain defers node deallocation") {
+    EpochDomain domain;
+    {
+        AvlSet<Tracked> a;
+        a.set_epoch_domain(&domain);
+        for (int i = 0; i < 100; ++i) {
+            a.insert(Tracked(i));
+        }
+        CHECK_EQ(Tracked::alive, 100);
+        {
+            auto guard = domain.pin();
+            auto it = a.find(Tracked(50));
+            a.erase(Tracked(50));
+            a.erase(Tracked(10));
+            domain.collect();
+            // Узел, на который смотрит читатель, ещё жив.
+            CHECK_EQ(it->value, 50);
+            CHECK_EQ(Tracked::alive, 100);
+            CHECK_EQ(a.size(), 98);
+        }
+        domain.drain();
+        CHECK_EQ(Tracked::alive, 98);
+    }
+    CHECK_EQ(Tracked::alive, 0);
+}
+
+TEST_CASE("EpochDomain with concurrent readers and a writer") {
+    EpochDomain domain;
+    std::atomic<bool> stop = false;
+    std::atomic<int> *slot = new std::atomic<int>(0);
+    std::atomic<std::atomic<int> *> shared = slot;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                auto guard = domain.pin();
+                std::atomic<int> *p = shared.load();
+                p->fetch_add(1);
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) {
+        std::atomic<int> *fresh = new std::atomic<int>(0);
+        std::atomic<int> *old = shared.exchange(fresh);
+        domain.retire(
+            old,
+            [](void *, void *ptr) {
+                delete static_cast<std::atomic<int> *>(ptr);
+            },
+            nullptr
+        );
+    }
+    stop = true;
+    for (auto &r : readers) {
+        r.join();
+    }
+    domain.drain();
+    CHECK_EQ(domain.pending(), 0);
+    delete shared.load();
+}
+
+TEST_CASE("EpochDomain unregisters from threads when destroyed") {
+    size_t before = EpochDomain::thread_domains();
+    EpochDomain kept;
+    auto kept_guard = kept.pin();
+    for (int i = 0; i < 1000; ++i) {
+        EpochDomain domain;
+        auto guard = domain.pin();
+        domain.retire(new int(i), count_free, nullptr);
+        CHECK_EQ(EpochDomain::thread_domains(), before + 2);
+    }
+    CHECK_EQ(EpochDomain::thread_domains(), before + 1);
+
+    // Поток, побывавший в домене, тоже снимается с учёта.
+    auto domain = std::make_unique<EpochDomain>();
+    std::atomic<bool> pinned = false;
+    std::atomic<bool> destroyed = false;
+    size_t seen = 0;
+    std::thread reader([&] {
+        {
+            auto guard = domain->pin();
+        }
+        pinned = true;
+        while (!destroyed) {
+            std::this_thread::yield();
+        }
+        seen = EpochDomain::thread_domains();
+    });
+    while (!pinned) {
+        std::this_thread::yield();
+    }
+    domain.reset();
+    destroyed = true;
+    reader.join();
+    CHECK_EQ(seen, 0);
+}
+
+TEST_CASE("EpochDomain::drain inside a guard throws instead of hanging") {
+    EpochDomain domain;
+    auto guard = domain.pin();
+    domain.retire(new int(1), count_free, nullptr);
+    CHECK_THROWS_AS(domain.drain(), std::logic_error);
+}
+
+TEST_CASE("AvlSet on a shared EpochDomain reclaims only its own nodes") {
+    EpochDomain domain;
+    AvlSet<Tracked> b;
+    b.set_epoch_domain(&domain);
+    for (int i = 0; i < 10; ++i) {
+        b.insert(Tracked(i));
+    }
+    for (int i = 0; i < 10; ++i) {
+        b.erase(Tracked(i));
+    }
+    CHECK_EQ(domain.pending(), 10);
+    {
+        AvlSet<Tracked> a;
+        a.set_epoch_domain(&domain);
+        for (int i = 0; i < 1000; ++i) {
+            a.insert(Tracked(i));
+        }
+        // Сборки, которые запускает a, не вызывают удалители b.
+        for (int i = 0; i < 500; ++i) {
+            a.erase(Tracked(i));
+        }
+        CHECK_GE(Tracked::alive, 510);
+        auto guard = domain.pin();
+        // Деструктор под EpochGuard не ждёт эпоху и не трогает узлы b.
+    }
+    CHECK_EQ(domain.pending(), 10);
+    CHECK_EQ(Tracked::alive, 10);
+    domain.drain();
+    CHECK_EQ(Tracked::alive, 0);
+}
@@ -0,0 +1,101 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../include/flat-combining-avl-set.hpp"
+#include "doctest.h"
+
+using my_algorithms::FlatCombiningAvlSet;
+
+TEST_CASE("FlatCombiningAvlSet single-threaded") {
+    FlatCombiningAvlSet<int> a;
+    CHECK(a.insert(5));
+    CHECK_FALSE(a.insert(5));
+    CHECK(a.insert(3));
+    CHECK(a.contains(3));
+    CHECK_FALSE(a.contains(4));
+    CHECK(a.erase(5));
+    CHECK_FALSE(a.erase(5));
+    CHECK_EQ(a.size(), 1);
+    CHECK_EQ(a.stats().operations, 7);
+}
+
+TEST_CASE("FlatCombiningAvlSet concurrent inserts and erases") {
+    FlatCombiningAvlSet<int, std::less<int>, std::allocator<int>, 8> a;
+    const int threads = 16;
+    const int per_thread = 5'000;
+    std::atomic<int> inserted = 0;
+    std::atomic<int> erased = 0;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            // Пересекающиеся ключи: каждый поток пишет в общий диапазон.
+            for (int i = 0; i < per_thread; ++i) {
+                inserted += a.insert((i * 7 + t) % 20'000);
+            }
+            for (int i = 0; i < per_thread; ++i) {
+                erased += a.erase((i * 13 + t) % 20'000);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    CHECK_EQ(a.size(), static_cast<size_t>(inserted - erased));
+
+    int prev = -1;
+    bool sorted = true;
+    a.for_each([&](int value) {
+        sorted = sorted && prev < value;
+        prev = value;
+    });
+    CHECK(sorted);
+    auto stats = a.stats();
+    CHECK_EQ(stats.operations, 2 * threads * per_thread);
+    CHECK(stats.passes <= stats.operations);
+}
+
+TEST_CASE("FlatCombiningAvlSet delivers exceptions to the publisher") {
+    // Сравнение с ключом 13 бросает: и при сортировке пачки, и в дереве.
+    struct ThrowingLess {
+        bool operator()(int a, int b) const {
+            if (a == 13 || b == 13) {
+                throw std::runtime_error("bad key");
+            }
+            return a < b;
+        }
+    };
+
+    FlatCombiningAvlSet<int, ThrowingLess, std::allocator<int>, 8> a;
+    a.insert(0);
+    const int threads = 8;
+    const int per_thread = 2'000;
+    std::atomic<int> thrown = 0;
+    std::atomic<int> inserted = 0;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                if (t == 0 && i % 10 == 0) {
+                    try {
+                        a.insert(13);
+                    } catch (const std::runtime_error &) {
+                        ++thrown;
+                    }
+                } else {
+                    inserted += a.insert(100 + t * per_thread + i);
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    CHECK_EQ(thrown.load(), per_thread / 10);
+    CHECK_EQ(inserted.load(), threads * per_thread - per_thread / 10);
+    CHECK_EQ(a.size(), 1 + inserted);
+    CHECK_THROWS_AS(a.contains(13), std::runtime_error);
+    CHECK(a.contains(101));
+}
@@ -0,0 +1,156 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "../include/index-arena.hpp"
+#include "doctest.h"
+
+using my_algorithms::AvlSet;
+using my_algorithms::IndexAllocator;
+using my_algorithms::IndexPtr;
+
+namespace {
+
+struct OtherTag {};
+struct CompactTag {};
+
+template <typename T, typename Tag = void>
+using IndexSet = AvlSet<T, std::less<T>, IndexAllocator<T, Tag>>;
+
+}  // namespace
+
+TEST_CASE("IndexPtr is 32 bits") {
+    CHECK_EQ(sizeof(IndexPtr<int>), 4);
+    IndexPtr<int> null;
+    CHECK_EQ(null.get(), nullptr);
+    CHECK_EQ(null.index(), 0);
+}
+
+TEST_CASE("Index arena converts both ways across pages") {
+    struct Cell {
+        std::uint64_t payload[3];
+    };
+    using Arena = my_algorithms::IndexArena<Cell, OtherTag>;
+    std::vector<Cell *> cells;
+    std::set<std::uint32_t> indices;
+    for (size_t i = 0; i < 20 * Arena::cells_per_page; ++i) {
+        Cell *cell = Arena::instance().allocate();
+        std::uint32_t index = Arena::index(cell);
+        CHECK_NE(index, 0);
+        CHECK_EQ(Arena::address(index), cell);
+        CHECK_EQ(IndexPtr<Cell, OtherTag>(cell).get(), cell);
+        indices.insert(index);
+        cells.push_back(cell);
+    }
+    CHECK_EQ(indices.size(), cells.size());
+    for (Cell *cell : cells) {
+        Arena::instance().deallocate(cell);
+    }
+}
+
+TEST_CASE("AvlSet with index links (compare with std::set)") {
+    IndexSet<int> a;
+    std::set<int> b;
+    std::mt19937 gen(3);
+    for (int i = 0; i < 100'000; ++i) {
+        int val = gen() % 30'000;
+        if (i % 3 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        if (i % 1000 == 0) {
+            val = gen() % 30'000;
+            CHECK_EQ(a.contains(val), b.count(val) == 1);
+            auto lb = a.lower_bound(val);
+            auto it = b.lower_bound(val);
+            CHECK_EQ(lb == a.end(), it == b.end());
+            if (it != b.end()) {
+                CHECK_EQ(*lb, *it);
+            }
+        }
+    }
+    std::vector<int> batch(20'000);
+    for (int &val : batch) {
+        val = gen() % 60'000;
+    }
+    a.insert_bulk(batch.begin(), batch.end());
+    b.insert(batch.begin(), batch.end());
+    CHECK_EQ(a.size(), b.size());
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+}
+
+TEST_CASE("Index arena reuses freed slots and separates tags") {
+    using Arena = my_algorithms::IndexArena<
+        typename IndexSet<std::string, OtherTag>::NodeAllocator::value_type,
+        OtherTag>;
+    IndexSet<std::string, OtherTag> a;
+    for (int i = 0; i < 5000; ++i) {
+        a.insert(std::to_string(i));
+    }
+    size_t used = Arena::instance().capacity_used();
+    for (int i = 0; i < 5000; i += 2) {
+        a.erase(std::to_string(i));
+    }
+    for (int i = 0; i < 5000; i += 2) {
+        a.insert("x" + std::to_string(i));
+    }
+    CHECK_EQ(Arena::instance().capacity_used(), used);
+    CHECK_EQ(a.size(), 5000);
+
+    IndexSet<std::string, OtherTag> b;
+    b.insert("only");
+    a.swap(b);
+    CHECK_EQ(a.size(), 1);
+    CHECK_EQ(*a.begin(), "only");
+    CHECK_EQ(b.size(), 5000);
+}
+
+TEST_CASE("AvlSet with index links compacts node by node") {
+    IndexSet<int, CompactTag> a;
+    std::set<int> b;
+    std::mt19937 gen(11);
+    for (int i = 0; i < 5000; ++i) {
+        int val = gen() % 1'000'000;
+        a.insert(val);
+        b.insert(val);
+    }
+    // Свободных ячеек в арене нет, так что новые идут подряд и рвутся
+    // только на границах страниц арены.
+    CHECK(a.compact());
+    using Node = IndexSet<int, CompactTag>::NodeAllocator::value_type;
+    using Arena = my_algorithms::IndexArena<Node, CompactTag>;
+    const Node *prev = nullptr;
+    size_t breaks = 0;
+    for (const int &value : a) {
+        // value — первое поле узла.
+        auto *node = reinterpret_cast<const Node *>(&value);
+        breaks += prev && node != prev + 1;
+        prev = node;
+    }
+    CHECK_LE(breaks, a.size() / (Arena::cells_per_page - 1) + 1);
+    CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    for (int round = 0; round < 3; ++round) {
+        CHECK_FALSE(a.compact(100));
+        for (int i = 0; i < 1000; ++i) {
+            int val = gen() % 1'000'000;
+            if (i % 2 == 0) {
+                a.erase(*b.begin());
+                b.erase(b.begin());
+            } else {
+                a.insert(val);
+                b.insert(val);
+            }
+        }
+        while (!a.compact(700)) {
+        }
+        CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+    }
+}
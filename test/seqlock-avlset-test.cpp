@@ -0,0 +1,91 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <atomic>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/seqlock-avl-set.hpp"
+#include "doctest.h"
+
+using my_algorithms::SeqlockAvlSet;
+
+TEST_CASE("SeqlockAvlSet single-threaded (compare with std::set)") {
+    SeqlockAvlSet<int> a;
+    std::set<int> b;
+    std::mt19937 gen(5);
+    for (int i = 0; i < 50'000; ++i) {
+        int val = gen() % 10'000;
+        if (i % 3 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        val = gen() % 12'000;
+        CHECK_EQ(a.contains(val), b.count(val) == 1);
+        auto lb = a.lower_bound(val);
+        auto it = b.lower_bound(val);
+        CHECK_EQ(lb.has_value(), it != b.end());
+        if (lb && it != b.end()) {
+            CHECK_EQ(*lb, *it);
+        }
+        auto ub = a.upper_bound(val);
+        it = b.upper_bound(val);
+        CHECK_EQ(ub.has_value(), it != b.end());
+        if (ub && it != b.end()) {
+            CHECK_EQ(*ub, *it);
+        }
+    }
+    CHECK_EQ(a.size(), b.size());
+    std::vector<int> aa;
+    a.for_each([&aa](int value) { aa.push_back(value); });
+    CHECK_EQ(aa, std::vector<int>(b.begin(), b.end()));
+}
+
+TEST_CASE("SeqlockAvlSet readers run while a writer churns") {
+    SeqlockAvlSet<std::string> a;
+    // Чётные ключи не трогаются писателем, нечётные постоянно меняются.
+    auto key = [](int i) { return std::to_string(100'000 + i); };
+    for (int i = 0; i < 2000; i += 2) {
+        a.insert(key(i));
+    }
+    std::atomic<bool> stop = false;
+    std::atomic<int> failures = 0;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            while (!stop.load()) {
+                int i = gen() % 1000 * 2;
+                if (!a.contains(key(i))) {
+                    ++failures;
+                }
+                auto lb = a.lower_bound(key(i + 1));
+                bool expected =
+                    lb ? *lb == key(i + 1) || *lb == key(i + 2) : i == 1998;
+                if (!expected) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    std::mt19937 gen(42);
+    for (int i = 0; i < 20'000; ++i) {
+        int k = gen() % 1000 * 2 + 1;
+        if (i % 2 == 0) {
+            a.insert(key(k));
+        } else {
+            a.erase(key(k));
+        }
+    }
+    stop = true;
+    for (auto &r : readers) {
+        r.join();
+    }
+    CHECK_EQ(failures.load(), 0);
+    for (int i = 0; i < 2000; i += 2) {
+        CHECK(a.contains(key(i)));
+    }
+}
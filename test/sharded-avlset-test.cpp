@@ -0,0 +1,130 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../include/sharded-avl-set.hpp"
+#include "doctest.h"
+
+using my_algorithms::ShardedAvlSet;
+
+TEST_CASE("ShardedAvlSet single-threaded (compare with std::set)") {
+    ShardedAvlSet<int, 8> a;
+    std::set<int> b;
+    std::mt19937 gen(3);
+    for (int i = 0; i < 50'000; ++i) {
+        int val = gen() % 20'000;
+        if (i % 3 == 0) {
+            CHECK_EQ(a.erase(val), b.erase(val) == 1);
+        } else {
+            CHECK_EQ(a.insert(val), b.insert(val).second);
+        }
+        if (i % 10'000 == 0) {
+            a.rebalance();
+        }
+        val = gen() % 25'000;
+        CHECK_EQ(a.contains(val), b.count(val) == 1);
+        auto lb = a.lower_bound(val);
+        auto it = b.lower_bound(val);
+        CHECK_EQ(lb.has_value(), it != b.end());
+        if (lb && it != b.end()) {
+            CHECK_EQ(*lb, *it);
+        }
+    }
+    CHECK_EQ(a.size(), b.size());
+    CHECK_EQ(a.boundaries().size(), 7);
+
+    std::vector<int> aa;
+    a.for_each([&aa](int value) { aa.push_back(value); });
+    CHECK_EQ(aa, std::vector<int>(b.begin(), b.end()));
+
+    size_t total = 0;
+    for (const auto &shard : a.stats()) {
+        total += shard.size;
+        CHECK(shard.size > 0);
+    }
+    CHECK_EQ(total, b.size());
+}
+
+TEST_CASE("ShardedAvlSet concurrent inserts and erases") {
+    ShardedAvlSet<int, 16> a({1000, 2000, 3000, 4000, 5000, 6000, 7000});
+    const int threads = 8;
+    const int per_thread = 20'000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&a, t] {
+            // Каждый поток работает со своими ключами: t, t + threads, ...
+            for (int i = 0; i < per_thread; ++i) {
+                a.insert(i * threads + t);
+            }
+            for (int i = 0; i < per_thread; i += 2) {
+                a.erase(i * threads + t);
+            }
+        });
+    }
+    std::thread balancer([&a] {
+        for (int i = 0; i < 5; ++i) {
+            a.rebalance();
+            std::this_thread::yield();
+        }
+    });
+    for (auto &w : workers) {
+        w.join();
+    }
+    balancer.join();
+
+    CHECK_EQ(a.size(), threads * per_thread / 2);
+    int prev = -1;
+    bool sorted = true;
+    a.for_each([&](int value) {
+        sorted = sorted && prev < value;
+        prev = value;
+    });
+    CHECK(sorted);
+    uint64_t acquisitions = 0;
+    for (const auto &shard : a.stats()) {
+        acquisitions += shard.acquisitions;
+    }
+    CHECK(acquisitions >= threads * per_thread);
+}
+
+TEST_CASE("ShardedAvlSet lower_bound during rebalancing") {
+    // Ключи не меняются, меняются только границы шардов: каждый ответ
+    // lower_bound должен совпадать с std::set.
+    ShardedAvlSet<int, 8> a;
+    std::set<int> b;
+    std::mt19937 gen(5);
+    // Ключей мало, так что ответ чаще лежит в одном из следующих шардов.
+    for (int i = 0; i < 30; ++i) {
+        int val = gen() % 100'000;
+        a.insert(val);
+        b.insert(val);
+    }
+    std::atomic<bool> done = false;
+    std::thread balancer([&a, &done] {
+        std::mt19937 gen(6);
+        while (!done) {
+            std::vector<int> keys;
+            for (int i = 0; i < 7; ++i) {
+                keys.push_back(gen() % 100'000);
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            a.set_boundaries(keys);
+        }
+    });
+    int mismatches = 0;
+    for (int i = 0; i < 200'000; ++i) {
+        int val = gen() % 110'000;
+        auto lb = a.lower_bound(val);
+        auto it = b.lower_bound(val);
+        if (lb.has_value() != (it != b.end()) || (lb && *lb != *it)) {
+            ++mismatches;
+        }
+    }
+    done = true;
+    balancer.join();
+    CHECK_EQ(mismatches, 0);
+}
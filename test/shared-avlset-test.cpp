@@ -0,0 +1,149 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <sys/wait.h>
+#include <unistd.h>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../include/avl-set.hpp"
+#include "../include/shared-segment.hpp"
+#include "doctest.h"
+
+using my_algorithms::AvlSet;
+using my_algorithms::OffsetPtr;
+using my_algorithms::SegmentAllocator;
+using my_algorithms::SharedSegment;
+
+namespace {
+
+using SharedSet = AvlSet<int, std::less<int>, SegmentAllocator<int>>;
+
+struct TempFile {
+    std::filesystem::path path;
+
+    explicit TempFile(const std::string &name)
+        : path(
+              std::filesystem::temp_directory_path() /
+              (name + "-" + std::to_string(::getpid()))
+          ) {
+    }
+
+    ~TempFile() {
+        std::filesystem::remove(path);
+    }
+};
+
+}  // namespace
+
+TEST_CASE("OffsetPtr keeps its target when copied") {
+    int values[3] = {1, 2, 3};
+    std::vector<OffsetPtr<int>> ptrs;
+    for (int &value : values) {
+        ptrs.emplace_back(&value);
+    }
+    ptrs.reserve(100);  // переезд в новый буфер
+    for (int i = 0; i < 3; ++i) {
+        CHECK_EQ(ptrs[i].get(), &values[i]);
+        CHECK_EQ(*ptrs[i], values[i]);
+    }
+    OffsetPtr<int> null;
+    CHECK_FALSE(null);
+    null = ptrs[1];
+    CHECK_EQ(null.get(), &values[1]);
+    null = nullptr;
+    CHECK_EQ(null.get(), nullptr);
+}
+
+TEST_CASE("AvlSet in a shared segment (compare with std::set)") {
+    TempFile file("shared-avlset");
+    std::set<int> b;
+    {
+        auto segment = SharedSegment::create(file.path, 1 << 22);
+        auto *a = segment.construct<SharedSet>(
+            segment.allocator<int>()
+        );
+        std::mt19937 gen(11);
+        for (int i = 0; i < 30'000; ++i) {
+            int val = gen() % 20'000;
+            if (i % 3 == 0) {
+                a->erase(val);
+                b.erase(val);
+            } else {
+                a->insert(val);
+                b.insert(val);
+            }
+        }
+        std::vector<int> batch(5000);
+        for (int &val : batch) {
+            val = gen() % 40'000;
+        }
+        a->insert_bulk(batch.begin(), batch.end());
+        b.insert(batch.begin(), batch.end());
+        CHECK_EQ(a->size(), b.size());
+
+        // Освобождённые узлы переиспользуются.
+        size_t used = segment.used();
+        for (int val : batch) {
+            a->erase(val);
+        }
+        for (int val : batch) {
+            a->insert(val);
+        }
+        CHECK_EQ(segment.used(), used);
+    }
+
+    // Второе отображение того же файла — по другому адресу.
+    auto first = SharedSegment::open(file.path);
+    auto second = SharedSegment::open(file.path);
+    CHECK_NE(first.base(), second.base());
+    for (auto *segment : {&first, &second}) {
+        const auto *a = segment->root<SharedSet>();
+        REQUIRE(a != nullptr);
+        CHECK_EQ(a->size(), b.size());
+        CHECK(std::equal(a->begin(), a->end(), b.begin(), b.end()));
+        for (int val = 0; val < 1000; ++val) {
+            CHECK_EQ(a->contains(val), b.count(val) == 1);
+        }
+    }
+    CHECK_THROWS_AS(first.allocator<int>(), std::logic_error);
+}
+
+TEST_CASE("AvlSet in a shared segment is readable from another process") {
+    TempFile file("shared-avlset-fork");
+    auto segment = SharedSegment::create(file.path, 1 << 20);
+    auto *a = segment.construct<SharedSet>(segment.allocator<int>());
+    for (int i = 0; i < 1000; ++i) {
+        a->insert(i * 3);
+    }
+    pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        auto mapped = SharedSegment::open(file.path);
+        const auto *tree = mapped.root<SharedSet>();
+        bool ok = tree->size() == 1000 && tree->contains(999 * 3) &&
+                  !tree->contains(1) && *tree->lower_bound(1) == 3;
+        ::_exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    REQUIRE_EQ(::waitpid(pid, &status, 0), pid);
+    CHECK(WIFEXITED(status));
+    CHECK_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST_CASE("SharedSegment reports exhaustion with bad_alloc") {
+    TempFile file("shared-avlset-full");
+    auto segment = SharedSegment::create(file.path, 4096);
+    auto *a = segment.construct<SharedSet>(segment.allocator<int>());
+    CHECK_THROWS_AS(
+        [a] {
+            for (int i = 0; i < 10'000; ++i) {
+                a->insert(i);
+            }
+        }(),
+        std::bad_alloc
+    );
+    CHECK_LE(segment.used(), segment.capacity());
+    CHECK_GT(a->size(), 0);
+}
@@ -0,0 +1,71 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../include/simd-search.hpp"
+#include "doctest.h"
+
+namespace simd = my_algorithms::simd;
+
+template <typename T>
+std::vector<T> getSortedBlock(std::mt19937 &gen, std::size_t n) {
+    std::uniform_int_distribution<long long> dist(-1000, 1000);
+    std::vector<T> res;
+    while (res.size() < n) {
+        res.push_back(static_cast<T>(dist(gen)));
+        std::sort(res.begin(), res.end());
+        res.erase(std::unique(res.begin(), res.end()), res.end());
+    }
+    return res;
+}
+
+template <typename T>
+void checkBlockSearch() {
+    std::mt19937 gen(42);
+    for (std::size_t n = 0; n <= 33; ++n) {
+        std::vector<T> keys = getSortedBlock<T>(gen, n);
+        for (long long k = -1100; k <= 1100; k += 7) {
+            T key = static_cast<T>(k);
+            auto expected = static_cast<std::size_t>(
+                std::lower_bound(keys.begin(), keys.end(), key) - keys.begin()
+            );
+            CHECK_EQ(simd::lower_bound(keys.data(), n, key), expected);
+            CHECK_EQ(
+                simd::detail::lower_bound_scalar(keys.data(), n, key), expected
+            );
+#ifdef MY_ALGORITHMS_SIMD_X86
+            CHECK_EQ(
+                simd::detail::lower_bound_sse2(keys.data(), n, key), expected
+            );
+            if (simd::active_isa() == simd::Isa::Avx2) {
+                CHECK_EQ(
+                    simd::detail::lower_bound_avx2(keys.data(), n, key),
+                    expected
+                );
+            }
+#endif
+            auto upper = static_cast<std::size_t>(
+                std::upper_bound(keys.begin(), keys.end(), key) - keys.begin()
+            );
+            CHECK_EQ(simd::upper_bound(keys.data(), n, key), upper);
+        }
+    }
+}
+
+TEST_CASE("SIMD block search (compare with std::lower_bound)") {
+    checkBlockSearch<int32_t>();
+    checkBlockSearch<uint32_t>();
+    checkBlockSearch<int64_t>();
+    checkBlockSearch<uint64_t>();
+    checkBlockSearch<float>();
+    checkBlockSearch<double>();
+}
+
+TEST_CASE("SIMD search applies only to plain arithmetic keys") {
+    CHECK(simd::is_searchable_v<int, std::less<int>>);
+    CHECK(simd::is_searchable_v<double, std::less<>>);
+    CHECK_FALSE(simd::is_searchable_v<int, std::greater<int>>);
+    CHECK_FALSE(simd::is_searchable_v<short, std::less<short>>);
+    CHECK_FALSE(simd::is_searchable_v<bool, std::less<bool>>);
+}
@@ -0,0 +1,78 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../include/small-avl-set.hpp"
+#include "doctest.h"
+
+int getRandomNumber() {
+    static std::mt19937 gen(11);
+    std::uniform_int_distribution<> dist(0, 1e9);
+    return dist(gen);
+}
+
+template <typename IterA, typename IterB>
+bool bounds_equal(IterA it_a, IterA end_a, IterB it_b, IterB end_b) {
+    if (it_a == end_a && it_b == end_b) {
+        return true;
+    }
+    if (it_a == end_a || it_b == end_b) {
+        return false;
+    }
+    return *it_a == *it_b;
+}
+
+using my_algorithms::SmallAvlSet;
+
+TEST_CASE("SmallAvlSet keeps few elements inline") {
+    SmallAvlSet<int, 8> a;
+    for (int i = 8; i > 0; --i) {
+        a.insert(i * 10);
+    }
+    a.insert(40);
+    CHECK(a.is_small());
+    CHECK_EQ(a.size(), 8);
+    CHECK_EQ(*a.begin(), 10);
+    CHECK_EQ(*a.lower_bound(35), 40);
+    CHECK_EQ(*a.upper_bound(40), 50);
+    CHECK(a.find(45) == a.end());
+
+    a.insert(45);
+    CHECK_FALSE(a.is_small());
+    CHECK_EQ(a.size(), 9);
+    std::vector<int> aa(a.begin(), a.end());
+    CHECK_EQ(aa, std::vector<int>{10, 20, 30, 40, 45, 50, 60, 70, 80});
+
+    for (int i = 1; i <= 7; ++i) {
+        a.erase(i * 10);
+    }
+    CHECK(a.is_small());
+    CHECK_EQ(a.size(), 2);
+    CHECK(a.contains(45));
+    CHECK(a.contains(80));
+}
+
+TEST_CASE("SmallAvlSet random operations (compare with std::set)") {
+    SmallAvlSet<std::string, 16> a;
+    std::set<std::string> b;
+    for (int i = 0; i < 20'000; ++i) {
+        std::string val = std::to_string(getRandomNumber() % 40);
+        if (getRandomNumber() % 2 == 0) {
+            a.erase(val);
+            b.erase(val);
+        } else {
+            a.insert(val);
+            b.insert(val);
+        }
+        CHECK_EQ(a.size(), b.size());
+        val = std::to_string(getRandomNumber() % 50);
+        CHECK(bounds_equal(
+            a.lower_bound(val), a.end(), b.lower_bound(val), b.end()
+        ));
+        CHECK(bounds_equal(a.find(val), a.end(), b.find(val), b.end()));
+    }
+    std::vector<std::string> aa(a.begin(), a.end());
+    std::vector<std::string> bb(b.begin(), b.end());
+    CHECK_EQ(aa, bb);
+}
@@ -0,0 +1,106 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "../include/tiered-avl-set.hpp"
+#include "doctest.h"
+
+using my_algorithms::TieredAvlSet;
+
+TEST_CASE("TieredAvlSet (compare with std::set)") {
+    std::mt19937 gen(5);
+    std::vector<int> keys;
+    for (int i = 0; i < 20'000; ++i) {
+        keys.push_back(gen() % 30'000);
+    }
+    TieredAvlSet<int> a(keys, 0);
+    std::set<int> b(keys.begin(), keys.end());
+    CHECK_EQ(a.size(), b.size());
+    CHECK_EQ(a.base_size(), b.size());
+    CHECK_EQ(a.delta_size(), 0);
+
+    for (int i = 0; i < 50'000; ++i) {
+        int val = gen() % 40'000;
+        if (i % 2 == 0) {
+            CHECK_EQ(a.erase(val), b.erase(val) == 1);
+        } else {
+            CHECK_EQ(a.insert(val), b.insert(val).second);
+        }
+        val = gen() % 45'000;
+        CHECK_EQ(a.contains(val), b.count(val) == 1);
+        auto lb = a.lower_bound(val);
+        auto it = b.lower_bound(val);
+        CHECK_EQ(lb == a.end(), it == b.end());
+        if (lb != a.end() && it != b.end()) {
+            CHECK_EQ(*lb, *it);
+        }
+        if (i % 10'000 == 0) {
+            CHECK_EQ(
+                std::vector<int>(a.begin(), a.end()),
+                std::vector<int>(b.begin(), b.end())
+            );
+        }
+    }
+    CHECK_EQ(a.size(), b.size());
+    CHECK_GT(a.delta_size(), 0);
+    CHECK_EQ(
+        std::vector<int>(a.begin(), a.end()),
+        std::vector<int>(b.begin(), b.end())
+    );
+
+    a.compact();
+    CHECK_EQ(a.delta_size(), 0);
+    CHECK_EQ(a.base_size(), b.size());
+    CHECK_EQ(
+        std::vector<int>(a.begin(), a.end()),
+        std::vector<int>(b.begin(), b.end())
+    );
+    CHECK(a.find(*b.begin()) == a.begin());
+    CHECK(a.find(-1) == a.end());
+
+    a.clear();
+    CHECK(a.empty());
+    CHECK(a.begin() == a.end());
+}
+
+TEST_CASE("TieredAvlSet erase everything from base") {
+    TieredAvlSet<int> a(std::vector<int>{5, 1, 3, 3, 1}, 0);
+    CHECK_EQ(a.size(), 3);
+    CHECK_FALSE(a.insert(3));
+    CHECK(a.erase(1));
+    CHECK_FALSE(a.erase(1));
+    CHECK(a.erase(3));
+    CHECK(a.erase(5));
+    CHECK(a.empty());
+    CHECK(a.begin() == a.end());
+    CHECK(a.insert(3));
+    CHECK(a.insert(4));
+    CHECK_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>{3, 4});
+    CHECK(a.lower_bound(4) != a.end());
+    CHECK(a.lower_bound(5) == a.end());
+}
+
+TEST_CASE("TieredAvlSet auto compaction") {
+    TieredAvlSet<int> a(std::vector<int>{}, 0.5);
+    std::set<int> b;
+    std::mt19937 gen(7);
+    size_t max_delta = 0;
+    for (int i = 0; i < 100'000; ++i) {
+        int val = gen() % 50'000;
+        if (i % 4 == 0) {
+            CHECK_EQ(a.erase(val), b.erase(val) == 1);
+        } else {
+            CHECK_EQ(a.insert(val), b.insert(val).second);
+        }
+        max_delta = std::max(max_delta, a.delta_size());
+    }
+    CHECK_GT(a.base_size(), 0);
+    CHECK_LE(a.delta_size(), std::max<size_t>(1024, a.base_size() / 2));
+    CHECK_LT(max_delta, b.size());
+    CHECK_EQ(
+        std::vector<int>(a.begin(), a.end()),
+        std::vector<int>(b.begin(), b.end())
+    );
+    CHECK_THROWS_AS(a.set_max_delta(-1), std::invalid_argument);
+}